@@ -0,0 +1,286 @@
+#ifndef CHECKPOINT_H_INCLUDED
+#define CHECKPOINT_H_INCLUDED
+
+#include "RubiksCube.h"
+#include "GeneticAlgorithm.h"
+
+/*
+ * Binary checkpoint of the distributed state. All ranks write their records in
+ * parallel into a single file with MPI-IO. Two files are used in turn, so the
+ * last completed checkpoint survives if the job is killed during writing.
+ *
+ * Layout: header (written by the root when all records are on disk) followed
+ * by one length-prefixed record per rank in rank order.
+ */
+class Checkpoint {
+private:
+	static const long long MAGIC = 0x54504B4341474352LL;
+	static const int HEADER_SIZE = 64;
+
+	struct Header {
+		long long magic;
+		long long size;
+		long long phase;
+		long long counter;
+		long long complete;
+	};
+
+	std::string prefix;
+
+	MPI_Comm comm;
+
+	MPI_File file;
+
+	MPI_Request request;
+
+	/* Data should stay alive until the non-blocking write is done. */
+	std::string data;
+
+	bool pending;
+
+	long generation;
+
+	Header header;
+
+	std::string name(long generation) const {
+		return( prefix + "." + std::to_string(generation%2) );
+	}
+
+	static void append(std::string &out, const void *value, size_t size) {
+		out.append((const char*)value, size);
+	}
+
+	static void append(std::string &out, const std::string &value) {
+		long long length = value.size();
+		append(out, &length, sizeof(length));
+		out += value;
+	}
+
+	static bool extract(const std::string &in, size_t &position, void *value, size_t size) {
+		if(position+size > in.size()) {
+			return( false );
+		}
+
+		memcpy(value, in.data()+position, size);
+		position += size;
+		return( true );
+	}
+
+	static bool extract(const std::string &in, size_t &position, std::string &value) {
+		long long length = 0;
+		if(extract(in, position, &length, sizeof(length)) == false || length < 0 || position+length > in.size()) {
+			return( false );
+		}
+
+		value = in.substr(position, length);
+		position += length;
+		return( true );
+	}
+
+	static bool readHeader(const std::string &name, Header &header) {
+		MPI_File file;
+		if(MPI_File_open(MPI_COMM_SELF, (char*)name.c_str(), MPI_MODE_RDONLY, MPI_INFO_NULL, &file) != MPI_SUCCESS) {
+			return( false );
+		}
+
+		memset(&header, 0, sizeof(header));
+		MPI_File_read_at(file, 0, &header, sizeof(header), MPI_BYTE, MPI_STATUS_IGNORE);
+		MPI_File_close(&file);
+
+		return( header.magic == MAGIC && header.complete != 0 );
+	}
+
+	/* Mark the file as complete, only after all ranks have finished writing. */
+	void commit() {
+		int rank = 0;
+		MPI_Comm_rank(comm, &rank);
+		if(rank != ROOT_NODE) {
+			return;
+		}
+
+		MPI_File file;
+		std::string value = name(generation);
+		if(MPI_File_open(MPI_COMM_SELF, (char*)value.c_str(), MPI_MODE_WRONLY, MPI_INFO_NULL, &file) != MPI_SUCCESS) {
+			return;
+		}
+		header.complete = 1;
+		MPI_File_write_at(file, 0, &header, sizeof(header), MPI_BYTE, MPI_STATUS_IGNORE);
+		MPI_File_sync(file);
+		MPI_File_close(&file);
+	}
+
+public:
+	Checkpoint(const std::string &prefix, MPI_Comm comm=MPI_COMM_WORLD) {
+		this->prefix = prefix;
+		this->comm = comm;
+		this->pending = false;
+		this->generation = 0;
+		this->request = MPI_REQUEST_NULL;
+		memset(&header, 0, sizeof(header));
+	}
+
+	~Checkpoint() {
+		/* Collective operations can not be done here, because other ranks may be gone. */
+		if(pending == true) {
+			MPI_Wait(&request, MPI_STATUS_IGNORE);
+		}
+	}
+
+	/* Record with the state of a single rank. The root keeps the definitions of the macro genes in its record. */
+	template<int N>
+	static std::string record(unsigned long seed, const RubiksCube<N> &cube, const std::string &path, GeneticAlgorithm &ga, const std::string &macros="") {
+		std::string result;
+
+		append(result, &seed, sizeof(seed));
+		append(result, &cube.getState(), sizeof(RubiksCubeState<N>));
+		append(result, path);
+
+		long long size = ga.size();
+		append(result, &size, sizeof(size));
+		for(int i=0; i<ga.size(); i++) {
+			const Chromosome &chromosome = ga.getChromosome(i);
+			append(result, &chromosome.fitness, sizeof(chromosome.fitness));
+			append(result, chromosome.command);
+		}
+		append(result, macros);
+
+		return( result );
+	}
+
+	template<int N>
+	static bool restore(const std::string &record, unsigned long &seed, RubiksCube<N> &cube, std::string &path, GeneticAlgorithm &ga, std::string *macros=NULL) {
+		size_t position = 0;
+
+		std::string value;
+		RubiksCubeState<N> state;
+		if(extract(record, position, &seed, sizeof(seed)) == false || extract(record, position, &state, sizeof(state)) == false || extract(record, position, path) == false) {
+			return( false );
+		}
+		cube.setState(state);
+
+		long long size = 0;
+		if(extract(record, position, &size, sizeof(size)) == false) {
+			return( false );
+		}
+
+		ga = GeneticAlgorithm();
+		for(long long i=0; i<size; i++) {
+			double fitness = INVALID_FITNESS_VALUE;
+			if(extract(record, position, &fitness, sizeof(fitness)) == false || extract(record, position, value) == false) {
+				return( false );
+			}
+			ga.setChromosome( Chromosome(value,fitness) );
+		}
+
+		/* Records written before the macro genes have none. */
+		if(macros != NULL && extract(record, position, *macros) == false) {
+			*macros = "";
+		}
+
+		return( true );
+	}
+
+	/* Collective call. The writing is started, but it is finished during the next call. */
+	void write(int phase, unsigned long counter, const std::string &record) {
+		int rank = 0;
+		int size = 0;
+		MPI_Comm_rank(comm, &rank);
+		MPI_Comm_size(comm, &size);
+
+		flush();
+		generation++;
+
+		data = "";
+		if(rank == ROOT_NODE) {
+			memset(&header, 0, sizeof(header));
+			header.magic = MAGIC;
+			header.size = size;
+			header.phase = phase;
+			header.counter = counter;
+			header.complete = 0;
+			append(data, &header, sizeof(header));
+			data.resize(HEADER_SIZE, '\0');
+		}
+		append(data, record);
+
+		long long length = data.size();
+		long long offset = 0;
+		MPI_Exscan(&length, &offset, 1, MPI_LONG_LONG, MPI_SUM, comm);
+		if(rank == ROOT_NODE) {
+			offset = 0;
+		}
+
+		std::string value = name(generation);
+		MPI_File_open(comm, (char*)value.c_str(), MPI_MODE_CREATE|MPI_MODE_WRONLY, MPI_INFO_NULL, &file);
+		MPI_File_iwrite_at(file, offset, (void*)data.data(), data.size(), MPI_BYTE, &request);
+		pending = true;
+	}
+
+	/* Collective call. Finish the pending writing. */
+	void flush() {
+		if(pending == false) {
+			return;
+		}
+
+		MPI_Wait(&request, MPI_STATUS_IGNORE);
+		MPI_File_close(&file);
+		MPI_Barrier(comm);
+		commit();
+		pending = false;
+	}
+
+	/* Load records of all ranks from the latest completed checkpoint. */
+	bool read(int &phase, unsigned long &counter, std::vector<std::string> &records) {
+		int size = 0;
+		MPI_Comm_size(comm, &size);
+
+		Header headers[2];
+		bool valid[2];
+		for(int g=0; g<2; g++) {
+			valid[g] = readHeader(name(g), headers[g]) && headers[g].size==size;
+		}
+
+		int latest = -1;
+		for(int g=0; g<2; g++) {
+			if(valid[g] == false) {
+				continue;
+			}
+			if(latest == -1 || headers[g].phase > headers[latest].phase || (headers[g].phase == headers[latest].phase && headers[g].counter > headers[latest].counter)) {
+				latest = g;
+			}
+		}
+		if(latest == -1) {
+			return( false );
+		}
+
+		MPI_File file;
+		std::string value = name(latest);
+		if(MPI_File_open(MPI_COMM_SELF, (char*)value.c_str(), MPI_MODE_RDONLY, MPI_INFO_NULL, &file) != MPI_SUCCESS) {
+			return( false );
+		}
+		MPI_Offset length = 0;
+		MPI_File_get_size(file, &length);
+		std::string content(length, '\0');
+		MPI_File_read_at(file, 0, &content[0], length, MPI_BYTE, MPI_STATUS_IGNORE);
+		MPI_File_close(&file);
+
+		records.clear();
+		size_t position = HEADER_SIZE;
+		for(int r=0; r<size; r++) {
+			if(extract(content, position, value) == false) {
+				return( false );
+			}
+			records.push_back(value);
+		}
+
+		phase = headers[latest].phase;
+		counter = headers[latest].counter;
+
+		/* Next checkpoint should not overwrite the one used for the restart. */
+		generation = latest;
+
+		return( true );
+	}
+};
+
+#endif
@@ -6,9 +6,17 @@ public:
 	double fitness;
 	std::string command;
 
-	Chromosome(std::string command, double fitness) {
+	/* Hash of the commands, so clones are found without comparing the strings. */
+	size_t genome;
+
+	/* Hash of the cube after the commands, zero when it is not known. */
+	unsigned long long state;
+
+	Chromosome(std::string command, double fitness, unsigned long long state=0) {
 		this->command = command;
 		this->fitness = fitness;
+		this->state = state;
+		rehash();
 	}
 
 	Chromosome(const Chromosome &chromosome) {
@@ -18,11 +26,20 @@ public:
 	Chromosome() {
 		this->command = "";
 		this->fitness = INVALID_FITNESS_VALUE;
+		this->state = 0;
+		rehash();
+	}
+
+	/* Should be called after the commands are changed in place. */
+	void rehash() {
+		genome = std::hash<std::string>()(command);
 	}
 
 	void operator=(const Chromosome &chromosome) {
 		this->command = chromosome.command;
 		this->fitness = chromosome.fitness;
+		this->genome = chromosome.genome;
+		this->state = chromosome.state;
 	}
 };
 
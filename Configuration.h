@@ -0,0 +1,151 @@
+#ifndef CONFIGURATION_H_INCLUDED
+#define CONFIGURATION_H_INCLUDED
+
+/*
+ * Parameters which can be changed without a new build. Each of them starts
+ * with the value of its constant and is set by lines NAME = VALUE, with the
+ * name of the constant, from a configuration file or from the command line.
+ * Lines which start with # are comments.
+ */
+class Configuration {
+public:
+	long populationSize;
+
+	long epoches;
+
+	long broadcasts;
+
+	long shufflingSteps;
+
+	bool randomTraveler;
+
+	bool commandsReduction;
+
+	/* Percents of the selections in which the result takes the place of a worse, a middle or a better chromosome. */
+	int intoWorst;
+	int intoMiddle;
+	int intoBest;
+
+private:
+	Configuration() {
+		reset();
+	}
+
+	static bool parse(const std::string &text, long &value, long minimum) {
+		char *end = NULL;
+		long result = strtol(text.c_str(), &end, 10);
+		if(text == "" || *end != '\0' || result < minimum) {
+			return( false );
+		}
+
+		value = result;
+		return( true );
+	}
+
+	static bool parse(const std::string &text, bool &value) {
+		if(text == "true" || text == "1") {
+			value = true;
+		} else if(text == "false" || text == "0") {
+			value = false;
+		} else {
+			return( false );
+		}
+
+		return( true );
+	}
+
+	static bool parse(const std::string &text, int &value, long minimum) {
+		long result = 0;
+		if(parse(text, result, minimum) == false || result > INT_MAX) {
+			return( false );
+		}
+
+		value = result;
+		return( true );
+	}
+
+public:
+	static Configuration& instance() {
+		static Configuration configuration;
+		return( configuration );
+	}
+
+	/* Values of the constants. */
+	void reset() {
+		populationSize = LOCAL_POPULATION_SIZE;
+		epoches = LOCAL_OPTIMIZATION_EPOCHES;
+		broadcasts = NUMBER_OF_BROADCASTS;
+		shufflingSteps = CUBE_SHUFFLING_STEPS;
+		randomTraveler = RANDOM_TRAVELER;
+		commandsReduction = COMMANDS_REDUCTION;
+		intoWorst = CROSSOVER_RESULT_INTO_WORST_PERCENT;
+		intoMiddle = CROSSOVER_RESULT_INTO_MIDDLE_PERCENT;
+		intoBest = CROSSOVER_RESULT_INTO_BEST_PERCENT;
+	}
+
+	/* False for an unknown name or a wrong value. */
+	bool set(const std::string &name, const std::string &value) {
+		if(name == "LOCAL_POPULATION_SIZE") {
+			return( parse(value, populationSize, 3) );
+		}
+		if(name == "LOCAL_OPTIMIZATION_EPOCHES") {
+			return( parse(value, epoches, 1) );
+		}
+		if(name == "NUMBER_OF_BROADCASTS") {
+			return( parse(value, broadcasts, 1) );
+		}
+		if(name == "CUBE_SHUFFLING_STEPS") {
+			return( parse(value, shufflingSteps, 0) );
+		}
+		if(name == "RANDOM_TRAVELER") {
+			return( parse(value, randomTraveler) );
+		}
+		if(name == "COMMANDS_REDUCTION") {
+			return( parse(value, commandsReduction) );
+		}
+		if(name == "CROSSOVER_RESULT_INTO_WORST_PERCENT") {
+			return( parse(value, intoWorst, 0) );
+		}
+		if(name == "CROSSOVER_RESULT_INTO_MIDDLE_PERCENT") {
+			return( parse(value, intoMiddle, 0) );
+		}
+		if(name == "CROSSOVER_RESULT_INTO_BEST_PERCENT") {
+			return( parse(value, intoBest, 0) );
+		}
+
+		return( false );
+	}
+
+	/* Lines NAME = VALUE. The wrong line is given back when it can not be applied. */
+	bool apply(const std::string &text, std::string &error) {
+		std::istringstream in(text);
+		std::string line;
+		while(std::getline(in, line)) {
+			if(line.find_first_not_of(" \t\r") == std::string::npos || line[line.find_first_not_of(" \t")] == '#') {
+				continue;
+			}
+
+			std::string::size_type equals = line.find('=');
+			std::string name;
+			std::string value;
+			if(equals != std::string::npos) {
+				std::istringstream(line.substr(0, equals)) >> name;
+				std::istringstream(line.substr(equals+1)) >> value;
+			}
+
+			if(equals == std::string::npos || set(name, value) == false) {
+				error = line;
+				return( false );
+			}
+		}
+
+		if(intoWorst+intoMiddle+intoBest <= 0) {
+			error = "CROSSOVER_RESULT_INTO_*_PERCENT";
+			return( false );
+		}
+
+		return( true );
+	}
+};
+
+#endif
@@ -1,24 +1,163 @@
 #ifndef CONSTANTS_H_INCLUDED
 #define CONSTANTS_H_INCLUDED
 
+/* Layers on each side of the cube, from 2 to 7. */
+#define CUBE_SIZE 3
+
 #define ROOT_NODE 0
 #define DEFAULT_TAG 0
 
-#define RECEIVE_BUFFER_SIZE 100000
-
 #define INVALID_FITNESS_VALUE INT_MAX
 
 #define LOCAL_POPULATION_SIZE 37
 #define LOCAL_OPTIMIZATION_EPOCHES 10000
 
+/* Epoches between the checks for the next population, while the worker evolves its island during the transfers (zero for blocking rounds, which are the only ones repeated exactly from the same seed). */
+#define WORKER_OVERLAP_EPOCHES 1
+
+/* Wall-clock seconds for a single round (zero for rounds defined only by epoches). */
+#define ROUND_TIME_BUDGET 0.0
+
+/* Threads which evolve the population of an island together (one for no threads). */
+#define PANMICTIC_THREADS 1
+
+/* Longest chromosome in a population evolved by many threads. */
+#define PANMICTIC_LENGTH 1000
+
+/* Threads which evaluate the offspring of an island by stealing the evaluations from each other (one for no threads). */
+#define EVALUATION_THREADS 1
+
+/* Values reported by a worker after each round: epoches, seconds, utilization and the tasks, stolen tasks and busy seconds of each evaluation thread. */
+#define WORKER_REPORT_SIZE (3+3*EVALUATION_THREADS)
+
+/* Rebalance epoches between ranks according to their measured speed. */
+#define ADAPTIVE_EPOCHES true
+
 #define CHROMOSOMES_INITIAL_SIZE 1
 
+/* Genes of a chromosome which are searched; crossover does not make longer chromosomes. */
+#define GENOME_HARD_LENGTH 1000
+
+/* Length after which each more gene makes the fitness worse by the parsimony weight. */
+#define GENOME_SOFT_LENGTH 300
+
+#define PARSIMONY_WEIGHT 0.01
+
+/* Fitness of each gene, so the shorter of two chromosomes with equal distance is better. Two euclidean distances differ at least by 1/(25*CUBE_SIZE), more than the tie break of the hard length; the other distances can differ less. */
+#define LENGTH_TIE_BREAK (1.0 / (25.0*CUBE_SIZE) / (GENOME_HARD_LENGTH+1))
+
+/* Mutations tried on a clone before it is dropped, and new random chromosomes tried instead of a clone. */
+#define DUPLICATE_RETRIES 8
+
 #define CUBE_SHUFFLING_STEPS 10000
 
 #define NUMBER_OF_BROADCASTS 47
 
 #define COMMANDS_REDUCTION true
 
+/* Chromosome is cut after its best prefix, which gives its fitness. */
+#define PREFIX_TRUNCATION true
+
 #define RANDOM_TRAVELER true
 
+/* Percents of the selections in which the result of the crossover takes the place of a worse, a middle or a better chromosome. */
+#define CROSSOVER_RESULT_INTO_WORST_PERCENT 90
+#define CROSSOVER_RESULT_INTO_MIDDLE_PERCENT 9
+#define CROSSOVER_RESULT_INTO_BEST_PERCENT 1
+
+/* Epoches between local searches from the best chromosome (zero for no local search). */
+#define MEMETIC_INTERVAL 500
+
+/* Moves added by a single local search. */
+#define MEMETIC_DEPTH 5
+
+/* Moves tried by a single local search. */
+#define MEMETIC_BUDGET 20000
+
+/* Moves from the solved cube covered by the table of finishing moves (zero for no table). */
+#define FINISHING_TABLE_DEPTH 8
+
+#define FINISHING_TABLE_FILE "RubiksCubeGA.table"
+
+/* Moves of the shortest sequences which replace longer segments of the solution (zero for no compression). */
+#define PEEPHOLE_TABLE_DEPTH 6
+
+/* Longest segment of the solution which is replaced at once. */
+#define PEEPHOLE_WINDOW 16
+
+/* Rounds between the mining of macro genes from the best chromosomes of the islands (zero for no macro genes). */
+#define MACRO_INTERVAL 5
+
+/* Macro genes in use at the same time. */
+#define MACRO_COUNT 4
+
+/* Longest sequence of moves in a macro gene. */
+#define MACRO_LENGTH 5
+
+/* Best chromosomes of each island from which the macro genes are mined. */
+#define MACRO_ELITES 5
+
+/* Characters of the macro genes, which are not commands of any cube. */
+#define MACRO_SYMBOLS "ACEGHIJKMOPQSUVWXYZ"
+
+/* Epoches between the exchanges of a worker with the hall of fame in the global migration experiments (zero for no hall of fame). */
+#define HALL_OF_FAME_INTERVAL 50
+
+/* Chromosomes kept in the hall of fame. */
+#define HALL_OF_FAME_SIZE 8
+
+/* Longest chromosome which can be put in the hall of fame. */
+#define HALL_OF_FAME_LENGTH 1000
+
+/* Epoches between the exchanges of an island with the next island on the same node in the ring migration experiments (zero for migration by the root). */
+#define NODE_MIGRATION_INTERVAL 10
+
+/* Epoches between the exchanges of the first islands of the nodes. */
+#define LEADER_MIGRATION_INTERVAL 100
+
+/* Longest chromosome which can migrate between the islands. */
+#define MIGRANT_LENGTH 1000
+
+#define NUMBER_OF_EXPERIMENTS 4
+
+/* Each island has its own distance, so a single run has the search of all distances and the experiments differ only in the migration. */
+#define ISLAND_METRICS false
+
+/* Distances of the islands in the order of the ranks. */
+#define ISLAND_DISTANCE_TYPES {EUCLIDEAN, WEIGHTED, HAUSDORFF}
+
+/* Distance by which the chromosomes of islands with different distances are compared. */
+#define FINAL_DISTANCE_TYPE EUCLIDEAN
+
+/* Repetitions of each experiment when the experiments are run concurrently. */
+#define NUMBER_OF_TRIALS 2
+
+/* Rounds between checkpoints (zero for no checkpoints). */
+#define CHECKPOINT_INTERVAL 5
+
+#define CHECKPOINT_FILE "RubiksCubeGA.checkpoint"
+
+/* Records of the rounds as JSON lines, written by a background thread of the root (empty name for no log). */
+#define PROGRESS_LOG_FILE "RubiksCubeGA.jsonl"
+
+/* Records which wait for the writer thread. New records are dropped when all of them wait. */
+#define PROGRESS_LOG_CAPACITY 4096
+
+/* Improvements of the paths of the workers, in one file for each rank with the rank after the name (empty name for no journal). */
+#define JOURNAL_FILE "RubiksCubeGA.journal"
+
+/* Bytes mapped when a journal is opened, the file grows when they are used. */
+#define JOURNAL_CAPACITY (1<<20)
+
+/* Best paths from the journals of earlier runs which are put in the first populations. */
+#define WARM_START_COUNT 10
+
+/* Processes in a group which solves one scramble at a time in batch mode. */
+#define GROUP_SIZE 4
+
+#define BATCH_DISTANCE_TYPE EUCLIDEAN
+
+/* Experiment which is run for each point of a parameter sweep. */
+#define SWEEP_EXPERIMENT 0
+
 #endif
@@ -0,0 +1,365 @@
+#ifndef FINISHINGTABLE_H_INCLUDED
+#define FINISHINGTABLE_H_INCLUDED
+
+#include "RubiksSide.h"
+#include "RubiksCube.h"
+#include "RubiksCubeMoves.h"
+#include "RubiksCubeTracker.h"
+#include "RubiksCubeSymmetry.h"
+
+/*
+ * All cubes which are at most a few moves away from the solved cube, with the
+ * exact number of moves for each of them. The table is found by breadth-first
+ * search from the solved cube with inverse moves, written to a file once and
+ * mapped into the memory of every rank, so the pages are shared on a node.
+ *
+ * A rotated cube needs the same number of moves, so only the canonical cube of
+ * each class of rotations is stored, which makes the table about 24 times
+ * smaller.
+ *
+ * The finishing moves are not stored. From a cube at depth d there is always
+ * a move which leads to a cube at depth d-1, so they are found one by one.
+ *
+ * Most cubes met by the search are far from the solved one, so a bitmap with
+ * two bits for the signature of each rotated cube rejects them before the
+ * canonical key is found and looked up.
+ *
+ * File layout: header, keys of all slots, depths of all slots (zero for empty
+ * slots and depth plus one for used slots), bitmap.
+ */
+template<int N>
+class FinishingTable {
+private:
+	static const int FACELETS = RubiksCubeMoves<N>::FACELETS;
+
+	/* Centers of the odd cubes do not move and are not in the keys. */
+	static const int PACKED = FACELETS - (N%2==1 ? 6 : 0);
+
+	/* Base 6 digits in a 64-bit word. */
+	static const int DIGITS = 24;
+
+	static const int WORDS = (PACKED+DIGITS-1) / DIGITS;
+
+	/* Cubes in the table should fit in the memory during the search. */
+	static const long long MAXIMUM_COUNT = 1LL << 26;
+
+	static const long long MAGIC = 0x4C42544847495347LL;
+
+	struct Header {
+		long long magic;
+		long long layers;
+		long long depth;
+		long long capacity;
+		long long count;
+		long long bits;
+	};
+
+	/* Colors of the facelets out of the centers as base 6 numbers. */
+	struct Key {
+		unsigned long long values[WORDS];
+	};
+
+	void *memory;
+
+	size_t length;
+
+	const Header *header;
+
+	const Key *keys;
+
+	const unsigned char *depths;
+
+	const unsigned char *filter;
+
+	RubiksCubeState<N> solved;
+
+	FinishingTable() {
+		memory = NULL;
+		length = 0;
+		header = NULL;
+		keys = NULL;
+		depths = NULL;
+		filter = NULL;
+		solved = RubiksCube<N>().getState();
+	}
+
+	~FinishingTable() {
+		close();
+	}
+
+	static Key pack(const RubiksCubeState<N> &state) {
+		const unsigned char *values = &state.sides[0][0][0];
+
+		Key key;
+		memset(&key, 0, sizeof(key));
+		for(int f=0, k=0; f<FACELETS; f++) {
+			if(N%2 == 1 && f%(N*N) == (N*N)/2) {
+				continue;
+			}
+			key.values[k/DIGITS] = key.values[k/DIGITS]*6 + (values[f]-RED);
+			k++;
+		}
+
+		return( key );
+	}
+
+	/* Hash of the raw facelets, which is faster than the packing of the key. */
+	static unsigned long long signature(const RubiksCubeState<N> &state) {
+		return( state.hash() );
+	}
+
+	static unsigned long long hash(const Key &key) {
+		unsigned long long value = 0;
+		for(int w=0; w<WORDS; w++) {
+			value = (value ^ key.values[w]) * 0x9E3779B97F4A7C15ULL;
+		}
+
+		return( value ^ (value >> 29) );
+	}
+
+	/* Slot of the key or the empty slot where it should be. */
+	static long long find(const Key table[], const unsigned char depths[], long long capacity, const Key &key) {
+		long long slot = hash(key) & (capacity-1);
+		while(depths[slot] != 0 && memcmp(&table[slot], &key, sizeof(key)) != 0) {
+			slot = (slot+1) & (capacity-1);
+		}
+
+		return( slot );
+	}
+
+	static Key canonical(const RubiksCubeState<N> &state) {
+		RubiksCubeState<N> result;
+		RubiksCubeSymmetry<N>::instance().canonical(state, result);
+		return( pack(result) );
+	}
+
+	static bool marked(const unsigned char filter[], long long bits, unsigned long long signature) {
+		unsigned long long first = signature & (bits-1);
+		unsigned long long second = (signature >> 32) & (bits-1);
+		return( (filter[first/8] & (1 << (first%8))) != 0 && (filter[second/8] & (1 << (second%8))) != 0 );
+	}
+
+	static void mark(unsigned char filter[], long long bits, unsigned long long signature) {
+		unsigned long long first = signature & (bits-1);
+		unsigned long long second = (signature >> 32) & (bits-1);
+		filter[first/8] |= 1 << (first%8);
+		filter[second/8] |= 1 << (second%8);
+	}
+
+	/* Depth of the cube or -1 when it is not in the table. */
+	int lookup(const RubiksCubeState<N> &state) const {
+		long long slot = find(keys, depths, header->capacity, canonical(state));
+		return( depths[slot] - 1 );
+	}
+
+	static long long capacity(long long count) {
+		long long result = 1;
+		while(result < 2*count) {
+			result *= 2;
+		}
+
+		return( result );
+	}
+
+	/* False if the class of the cube is already in the table. Signatures of all rotated cubes are collected for the bitmap. */
+	static bool insert(Key table[], unsigned char marks[], long long size, std::vector<unsigned long long> &signatures, const RubiksCubeState<N> &state, int depth) {
+		const RubiksCubeSymmetry<N> &symmetry = RubiksCubeSymmetry<N>::instance();
+
+		Key key = canonical(state);
+		long long slot = find(table, marks, size, key);
+		if(marks[slot] != 0) {
+			return( false );
+		}
+		table[slot] = key;
+		marks[slot] = depth + 1;
+
+		for(int s=0; s<RubiksCubeSymmetry<N>::COUNT; s++) {
+			if(symmetry.isReflection(s) == false) {
+				RubiksCubeState<N> rotated;
+				symmetry.transform(s, state, rotated);
+				signatures.push_back(signature(rotated));
+			}
+		}
+
+		return( true );
+	}
+
+	void close() {
+		if(memory != NULL) {
+			munmap(memory, length);
+		}
+		memory = NULL;
+		header = NULL;
+	}
+
+public:
+	static FinishingTable<N>& instance() {
+		static FinishingTable<N> table;
+		return( table );
+	}
+
+	bool loaded() const {
+		return( header != NULL );
+	}
+
+	/* Only cubes compared with the solved cube can be finished. */
+	bool covers(const RubiksCubeTracker<N> &tracker) const {
+		return( header != NULL && memcmp(&tracker.getReference(), &solved, sizeof(solved)) == 0 );
+	}
+
+	/* Moves which solve the cube, when it is in the table. */
+	bool finish(const RubiksCubeTracker<N> &tracker, std::string &moves) const {
+		const std::string &alphabet = RubiksCube<N>::alphabet();
+
+		RubiksCubeState<N> state = tracker.getState();
+		if(marked(filter, header->bits, signature(state)) == false) {
+			return( false );
+		}
+
+		int depth = lookup(state);
+		if(depth < 0) {
+			return( false );
+		}
+
+		moves = "";
+		while(depth > 0) {
+			for(int m=0; m<alphabet.length(); m++) {
+				RubiksCubeState<N> next = state;
+				RubiksCubeMoves<N>::apply(*RubiksCubeMoves<N>::instance().find(alphabet[m]), &next.sides[0][0][0]);
+				if(lookup(next) == depth-1) {
+					moves += alphabet[m];
+					state = next;
+					depth--;
+					break;
+				}
+			}
+		}
+
+		return( true );
+	}
+
+	/* Map the table from the file. False if the file is missing or it was built for other depth. */
+	bool open(const std::string &name, int depth) {
+		close();
+
+		int file = ::open(name.c_str(), O_RDONLY);
+		if(file < 0) {
+			return( false );
+		}
+
+		struct stat status;
+		if(fstat(file, &status) != 0 || status.st_size < (off_t)sizeof(Header)) {
+			::close(file);
+			return( false );
+		}
+
+		length = status.st_size;
+		memory = mmap(NULL, length, PROT_READ, MAP_SHARED, file, 0);
+		::close(file);
+		if(memory == MAP_FAILED) {
+			memory = NULL;
+			return( false );
+		}
+
+		const Header *value = (const Header*)memory;
+		if(value->magic != MAGIC || value->layers != N || value->depth != depth || length != sizeof(Header) + value->capacity*(sizeof(Key)+1) + value->bits/8) {
+			close();
+			return( false );
+		}
+
+		header = value;
+		keys = (const Key*)((const char*)memory + sizeof(Header));
+		depths = (const unsigned char*)(keys + header->capacity);
+		filter = depths + header->capacity;
+
+		return( true );
+	}
+
+	/* Breadth-first search from the solved cube over canonical cubes. The file is replaced only when it is complete. */
+	static bool build(const std::string &name, int depth) {
+		const std::string &alphabet = RubiksCube<N>::alphabet();
+
+		/* Upper bound of the number of cubes. */
+		long long count = 1;
+		for(long long d=1, level=1; d<=depth; d++) {
+			level *= alphabet.length();
+			count += level;
+			if(count > MAXIMUM_COUNT) {
+				return( false );
+			}
+		}
+
+		long long size = capacity(count);
+		std::vector<Key> table(size);
+		std::vector<unsigned char> marks(size, 0);
+		std::vector<unsigned long long> signatures;
+
+		Header header;
+		memset(&header, 0, sizeof(header));
+		header.magic = MAGIC;
+		header.layers = N;
+		header.depth = depth;
+
+		std::vector< RubiksCubeState<N> > frontier(1, RubiksCube<N>().getState());
+		insert(&table[0], &marks[0], size, signatures, frontier[0], 0);
+		count = 1;
+
+		for(int d=1; d<=depth; d++) {
+			std::vector< RubiksCubeState<N> > next;
+			for(int i=0; i<frontier.size(); i++) {
+				for(int m=0; m<alphabet.length(); m++) {
+					/* Three turns of a layer are the inverse move. */
+					RubiksCubeState<N> state = frontier[i];
+					const typename RubiksCubeMoves<N>::Move &move = *RubiksCubeMoves<N>::instance().find(alphabet[m]);
+					for(int t=0; t<3; t++) {
+						RubiksCubeMoves<N>::apply(move, &state.sides[0][0][0]);
+					}
+
+					if(insert(&table[0], &marks[0], size, signatures, state, d) == true) {
+						next.push_back(state);
+						count++;
+					}
+				}
+			}
+			frontier.swap(next);
+		}
+
+		/* The file holds a smaller table with the same cubes. */
+		header.count = count;
+		header.capacity = capacity(count);
+		std::vector<Key> keys(header.capacity);
+		std::vector<unsigned char> depths(header.capacity, 0);
+		for(long long s=0; s<size; s++) {
+			if(marks[s] == 0) {
+				continue;
+			}
+			long long position = find(&keys[0], &depths[0], header.capacity, table[s]);
+			keys[position] = table[s];
+			depths[position] = marks[s];
+		}
+
+		header.bits = 8;
+		while(header.bits < 16*signatures.size()) {
+			header.bits *= 2;
+		}
+		std::vector<unsigned char> filter(header.bits/8, 0);
+		for(long long i=0; i<signatures.size(); i++) {
+			mark(&filter[0], header.bits, signatures[i]);
+		}
+
+		std::string temporary = name + ".tmp";
+		std::ofstream out(temporary.c_str(), std::ios::binary);
+		out.write((const char*)&header, sizeof(header));
+		out.write((const char*)&keys[0], keys.size()*sizeof(Key));
+		out.write((const char*)&depths[0], depths.size());
+		out.write((const char*)&filter[0], filter.size());
+		out.close();
+		if(out.fail() == true) {
+			return( false );
+		}
+
+		return( rename(temporary.c_str(), name.c_str()) == 0 );
+	}
+};
+
+#endif
@@ -2,6 +2,7 @@
 #define GENETICALGORITHM_H_INCLUDED
 
 #include "Chromosome.h"
+#include "Configuration.h"
 
 class GeneticAlgorithm {
 private:
@@ -12,16 +13,54 @@ private:
 	int bestIndex;
 	int worstIndex;
 
+	/* Chromosome which was at the result index before the crossover. */
+	Chromosome replaced;
+
 	void selectRandom() {
 		do {
-			resultIndex = rand() % population.size();
-			firstIndex = rand() % population.size();
-			secondIndex = rand() % population.size();
+			resultIndex = random() % population.size();
+			firstIndex = random() % population.size();
+			secondIndex = random() % population.size();
 		} while(resultIndex==firstIndex || resultIndex==secondIndex || (resultIndex == bestIndex && KEEP_ELITE==true) || population[firstIndex].command.length()==0 || population[secondIndex].command.length()==0);
 	}
 
+	/* First character of the text which has only the changed chromosomes. */
+	static const char DELTA = 'D';
+
+	/* Both indices from all fitness values. */
+	void rescan() {
+		bestIndex = 0;
+		worstIndex = 0;
+		for(int i=0; i<population.size(); i++) {
+			if(population[i].fitness < population[bestIndex].fitness) {
+				bestIndex = i;
+			}
+			if(population[i].fitness > population[worstIndex].fitness) {
+				worstIndex = i;
+			}
+		}
+	}
+
 	friend std::ostream& operator<< (std::ostream &out, const GeneticAlgorithm &ga);
 
+	/* Genes which can be put by the mutation. */
+	static std::string& genes() {
+		static std::string values = {TOP, LEFT, RIGHT, FRONT, BACK, DOWN};
+		return( values );
+	}
+
+	/* Macro genes, which stand for sequences of moves. */
+	static std::string& macros() {
+		static std::string values = "";
+		return( values );
+	}
+
+	/* Random numbers of the calling thread, NULL for the numbers of rand(). */
+	static std::minstd_rand*& engine() {
+		static thread_local std::minstd_rand *value = NULL;
+		return( value );
+	}
+
 public:
 	static const bool KEEP_ELITE = true;
 
@@ -42,6 +81,33 @@ public:
 		(*this) = ga;
 	}
 
+	/* Should be set before any optimization, when the cube has more moves than the turns of the sides. */
+	static void setAlphabet(const std::string &alphabet) {
+		genes() = alphabet;
+	}
+
+	static const std::string& getAlphabet() {
+		return( genes() );
+	}
+
+	/* Macro genes are put by the mutation together with the moves. */
+	static void setMacros(const std::string &symbols) {
+		macros() = symbols;
+	}
+
+	/* Threads which run the operators at the same time should have their own generators. */
+	static void setEngine(std::minstd_rand *generator) {
+		engine() = generator;
+	}
+
+	static int random() {
+		if(engine() == NULL) {
+			return( rand() );
+		}
+
+		return( (*engine())() );
+	}
+
 	int getResultIndex() {
 		return( resultIndex );
 	}
@@ -85,26 +151,35 @@ public:
 	}
 
 	const Chromosome& getRandomChromosome() const {
-		return( population[rand()%population.size()] );
+		return( population[random()%population.size()] );
 	}
 
 	const Chromosome& getWorstChromosome() const {
 		return( population[worstIndex] );
 	}
 
-	void replaceWorst(const Chromosome& chromosome) {
-		population[worstIndex] = chromosome;
-
-		bestIndex = 0;
-		worstIndex = 0;
+	/* True when a chromosome with the same commands or with the same known cube is in the population. */
+	bool contains(const Chromosome &chromosome) const {
 		for(int i=0; i<population.size(); i++) {
-			if(population[i].fitness < population[bestIndex].fitness) {
-				bestIndex = i;
+			if(population[i].genome == chromosome.genome && population[i].command == chromosome.command) {
+				return( true );
 			}
-			if(population[i].fitness > population[worstIndex].fitness) {
-				worstIndex = i;
+			if(chromosome.state != 0 && population[i].state == chromosome.state) {
+				return( true );
 			}
 		}
+
+		return( false );
+	}
+
+	/* Clones are not inserted. */
+	void replaceWorst(const Chromosome& chromosome) {
+		if(contains(chromosome) == true) {
+			return;
+		}
+
+		population[worstIndex] = chromosome;
+		rescan();
 	}
 
 	void setFitness(double fitness, int index=-1) {
@@ -143,98 +218,97 @@ public:
 		return( population.size() );
 	}
 
+	/* Random chromosomes without repetitions and without clones of the chromosomes which are already in the other population. */
 	void subset(GeneticAlgorithm &ga, const int size) const {
 		if(population.size() <= 0) {
 			return;
 		}
 
-		for(int i=0; i<size; i++) {
-			ga.setChromosome( population[ rand()%population.size() ] );
+		std::vector<int> indices(population.size());
+		for(int i=0; i<indices.size(); i++) {
+			indices[i] = i;
+		}
+
+		for(int i=0, added=0; i<indices.size() && added<size; i++) {
+			std::swap(indices[i], indices[i + random()%(indices.size()-i)]);
+			if(ga.contains(population[indices[i]]) == false) {
+				ga.setChromosome( population[indices[i]] );
+				added++;
+			}
 		}
 	}
 
-	void selection() {
-		static const int CROSSOVER_RESULT_INTO_BEST_PERCENT = 1;
-		static const int CROSSOVER_RESULT_INTO_MIDDLE_PERCENT = 9;
-		static const int CROSSOVER_RESULT_INTO_WORST_PERCENT = 90;
-
-		static int percent = -1;
-		percent = rand()
-				  % (CROSSOVER_RESULT_INTO_WORST_PERCENT
-					 + CROSSOVER_RESULT_INTO_MIDDLE_PERCENT
-					 + CROSSOVER_RESULT_INTO_BEST_PERCENT);
-
-		if (percent < CROSSOVER_RESULT_INTO_WORST_PERCENT) {
-			do {
-				selectRandom();
-			} while (population[resultIndex].fitness < population[firstIndex].fitness
-					 || population[resultIndex].fitness < population[secondIndex].fitness);
-		} else if (percent
-				   < (CROSSOVER_RESULT_INTO_WORST_PERCENT
-					  + CROSSOVER_RESULT_INTO_MIDDLE_PERCENT)) {
-			do {
-				selectRandom();
-			} while (population[resultIndex].fitness < population[firstIndex].fitness
-					 || population[resultIndex].fitness > population[secondIndex].fitness);
-		} else if (percent
-				   < (CROSSOVER_RESULT_INTO_WORST_PERCENT
-					  + CROSSOVER_RESULT_INTO_MIDDLE_PERCENT
-					  + CROSSOVER_RESULT_INTO_BEST_PERCENT)) {
-			do {
-				selectRandom();
-			} while (population[resultIndex].fitness > population[firstIndex].fitness
-					 || population[resultIndex].fitness > population[secondIndex].fitness);
+	/* Number of different commands, number of different fitness values and the average length of the chromosomes. */
+	void diversity(int &genomes, int &fitnesses, double &length) const {
+		std::set<std::string> commands;
+		std::set<double> values;
+
+		length = 0;
+		for(int i=0; i<population.size(); i++) {
+			commands.insert(population[i].command);
+			values.insert(population[i].fitness);
+			length += population[i].command.length();
+		}
+
+		genomes = commands.size();
+		fitnesses = values.size();
+		if(population.size() > 0) {
+			length /= population.size();
 		}
 	}
 
-	void crossover() {
-		population[resultIndex].command = population[firstIndex].command.substr(0, rand()%(population[firstIndex].command.length())+1);
-		population[resultIndex].command += population[secondIndex].command.substr(rand()%population[secondIndex].command.length(), population[secondIndex].command.length());
-		population[resultIndex].fitness = INVALID_FITNESS_VALUE;
+	/* Kind of the selection as a percent: the result takes the place of a worse, a middle or a better chromosome. */
+	static int kind() {
+		const Configuration &configuration = Configuration::instance();
+		return( random() % (configuration.intoWorst + configuration.intoMiddle + configuration.intoBest) );
 	}
 
-	void mutation() {
-		int index = rand() % population[resultIndex].command.length();
-
-		switch(rand()%6) {
-		case 0:
-			population[resultIndex].command[index]=(char)TOP;
-			break;
-		case 1:
-			population[resultIndex].command[index]=(char)LEFT;
-			break;
-		case 2:
-			population[resultIndex].command[index]=(char)RIGHT;
-			break;
-		case 3:
-			population[resultIndex].command[index]=(char)FRONT;
-			break;
-		case 4:
-			population[resultIndex].command[index]=(char)BACK;
-			break;
-		case 5:
-			population[resultIndex].command[index]=(char)DOWN;
-			break;
+	/* True when the fitness values of the chosen chromosomes match the kind of the selection. */
+	static bool fits(int percent, double result, double first, double second) {
+		const Configuration &configuration = Configuration::instance();
+		if (percent < configuration.intoWorst) {
+			return( result >= first && result >= second );
+		} else if (percent < (configuration.intoWorst + configuration.intoMiddle)) {
+			return( result >= first && result <= second );
 		}
 
-		population[resultIndex].fitness = INVALID_FITNESS_VALUE;
+		return( result <= first && result <= second );
 	}
 
-	void reduction() {
+	/* Beginning of the first commands and end of the second commands, cut at the hard length. */
+	static std::string cross(const std::string &first, const std::string &second) {
+		std::string result = first.substr(0, random()%(first.length())+1);
+		result += second.substr(random()%second.length(), second.length());
+		if(result.length() > GENOME_HARD_LENGTH) {
+			result.resize(GENOME_HARD_LENGTH);
+		}
+		return( result );
+	}
+
+	static void mutate(std::string &commands) {
+		const std::string &alphabet = genes();
+		const std::string &symbols = macros();
+		int index = random() % commands.length();
+
+		int gene = random() % (alphabet.length()+symbols.length());
+		commands[index] = gene<alphabet.length() ? alphabet[gene] : symbols[gene-alphabet.length()];
+	}
+
+	static void reduce(std::string &value) {
 		static const char nop[] = {NONE, '\0'};
 
-		if(COMMANDS_REDUCTION == false) {
+		if(Configuration::instance().commandsReduction == false) {
 			return;
 		}
 
 		bool done = true;
-		std::string &value = population[resultIndex].command;
 
 		do {
 			done = true;
 
 			for(int i=1, j=0; i<value.size(); i++) {
-				if(value[i] == value[i-1]) {
+				/* Four macro genes in a row do not give the same cube. */
+				if(value[i] == value[i-1] && macros().find(value[i]) == std::string::npos) {
 					j++;
 				} else {
 					j = 0;
@@ -251,6 +325,85 @@ public:
 		} while(done == false);
 	}
 
+	/* Shortest, average and longest chromosome. */
+	void lengths(int &minimum, double &average, int &maximum) const {
+		minimum = 0;
+		average = 0;
+		maximum = 0;
+		for(int i=0; i<population.size(); i++) {
+			int length = population[i].command.length();
+			if(i == 0 || length < minimum) {
+				minimum = length;
+			}
+			if(length > maximum) {
+				maximum = length;
+			}
+			average += length;
+		}
+
+		if(population.size() > 0) {
+			average /= population.size();
+		}
+	}
+
+	void selection() {
+		const int percent = kind();
+
+		do {
+			selectRandom();
+		} while (fits(percent, population[resultIndex].fitness, population[firstIndex].fitness, population[secondIndex].fitness) == false);
+	}
+
+	void crossover() {
+		replaced = population[resultIndex];
+
+		population[resultIndex].command = cross(population[firstIndex].command, population[secondIndex].command);
+		population[resultIndex].fitness = INVALID_FITNESS_VALUE;
+	}
+
+	void mutation() {
+		mutate(population[resultIndex].command);
+		population[resultIndex].fitness = INVALID_FITNESS_VALUE;
+	}
+
+	void reduction() {
+		reduce(population[resultIndex].command);
+	}
+
+	/* True when the result of the crossover has the same commands as another chromosome. */
+	bool duplicate() {
+		Chromosome &result = population[resultIndex];
+		result.rehash();
+
+		for(int i=0; i<population.size(); i++) {
+			if(i != resultIndex && population[i].genome == result.genome && population[i].command == result.command) {
+				return( true );
+			}
+		}
+
+		return( false );
+	}
+
+	/* True when another chromosome gives the same cube. */
+	bool duplicate(unsigned long long state) const {
+		if(state == 0) {
+			return( false );
+		}
+
+		for(int i=0; i<population.size(); i++) {
+			if(i != resultIndex && population[i].state == state) {
+				return( true );
+			}
+		}
+
+		return( false );
+	}
+
+	/* The result of the crossover is dropped and the previous chromosome takes its place back. */
+	void reject() {
+		population[resultIndex] = replaced;
+	}
+
 	const std::string& toString() {
 		static std::string result;
 		result = "";
@@ -268,6 +421,8 @@ public:
 				result += population[i].command;
 			}
 			result += " ";
+			result += std::to_string(population[i].state);
+			result += " ";
 		}
 
 		/* Trim spaces. */
@@ -290,11 +445,13 @@ public:
 
 		double value;
 		std::string commands;
+		unsigned long long state;
 		for(int i=0; i<size; i++) {
 			in >> value;
 			in >> commands;
+			in >> state;
 
-			setChromosome(Chromosome(commands,value));
+			setChromosome(Chromosome(commands,value,state));
 
 			if(population[bestIndex].fitness > population[i].fitness) {
 				bestIndex = i;
@@ -305,6 +462,90 @@ public:
 		}
 	}
 
+	/*
+	 * Only the chromosomes which differ from the population known by the other
+	 * side, by slot, and the slots with the same commands but another fitness
+	 * or another hash of the cube. The whole population is given when the sizes differ or when most of the
+	 * chromosomes are new. The other side applies the text to its copy with
+	 * fromDelta() and so should the sender, so both copies stay the same.
+	 */
+	const std::string& toDelta(const GeneticAlgorithm &previous) {
+		static std::string result;
+
+		if(population.size() == 0 || population.size() != previous.population.size()) {
+			return( toString() );
+		}
+
+		std::string changed = "";
+		std::string updated = "";
+		int commands = 0;
+		int fitnesses = 0;
+		for(int i=0; i<population.size(); i++) {
+			const Chromosome &current = population[i];
+			const Chromosome &known = previous.population[i];
+			std::string fitness = std::to_string(current.fitness);
+			std::string command = (current.command == "") ? std::string(1, NONE) : current.command;
+			std::string state = std::to_string(current.state);
+
+			if(command != known.command) {
+				changed += " " + std::to_string(i) + " " + fitness + " " + command + " " + state;
+				commands++;
+			} else if(fitness != std::to_string(known.fitness) || current.state != known.state) {
+				updated += " " + std::to_string(i) + " " + fitness + " " + state;
+				fitnesses++;
+			}
+		}
+
+		if(2*commands > population.size()) {
+			return( toString() );
+		}
+
+		result = std::string(1, DELTA) + " " + std::to_string(commands) + changed + " " + std::to_string(fitnesses) + updated;
+		result += '\0';
+
+		return result;
+	}
+
+	/* Text of toString() or of toDelta() against this population. */
+	void fromDelta(const char text[]) {
+		if(text[0] != DELTA) {
+			fromString(text);
+			return;
+		}
+
+		std::istringstream in(text+1);
+
+		int index = 0;
+		double value = 0;
+		std::string commands;
+		unsigned long long state = 0;
+
+		int size = 0;
+		in >> size;
+		for(int i=0; i<size; i++) {
+			in >> index;
+			in >> value;
+			in >> commands;
+			in >> state;
+			if(index >= 0 && index < population.size()) {
+				population[index] = Chromosome(commands,value,state);
+			}
+		}
+
+		in >> size;
+		for(int i=0; i<size; i++) {
+			in >> index;
+			in >> value;
+			in >> state;
+			if(index >= 0 && index < population.size()) {
+				population[index].fitness = value;
+				population[index].state = state;
+			}
+		}
+
+		rescan();
+	}
+
 	void operator=(const GeneticAlgorithm &ga) {
 		this->population.clear();
 
@@ -314,6 +555,7 @@ public:
 		this->secondIndex = ga.secondIndex;
 		this->bestIndex = ga.bestIndex;
 		this->worstIndex = ga.worstIndex;
+		this->replaced = ga.replaced;
 	}
 };
 
@@ -2,47 +2,524 @@
 #define GENETICALGORITHMOPTIMIZER_H_INCLUDED
 
 #include "RubiksSide.h"
+#include "RubiksCubeTracker.h"
+#include "MemeticSearch.h"
+#include "FinishingTable.h"
+#include "MacroGenes.h"
+#include "HallOfFame.h"
+#include "NodeMigration.h"
+#include "SharedPopulation.h"
+#include "TaskPool.h"
 
 class GeneticAlgorithmOptimizer {
 private:
-	static double evaluate(const RubiksCube &solved, const RubiksCube &shuffled, const std::string &commands) {
-		static RubiksCube used;
+	/* Fitness added for the length in turns, which orders chromosomes with equal distance and pushes back the too long ones. */
+	static double parsimony(int length) {
+		double result = LENGTH_TIE_BREAK * length;
+		if(length > GENOME_SOFT_LENGTH) {
+			result += PARSIMONY_WEIGHT * (length-GENOME_SOFT_LENGTH);
+		}
 
-		used = shuffled;
-		used.execute(commands);
-		return( solved.compare(used) );
+		return( result );
 	}
 
-	GeneticAlgorithmOptimizer() {
+	/* The fitness is the best distance after any prefix of the commands together with the parsimony of the kept commands, and the rest of the commands can be cut. The state is the hash of the cube after the kept commands. */
+	template<int N>
+	static double evaluate(const RubiksCubeTracker<N> &origin, std::string &commands, unsigned long long &state) {
+		static const char nop[] = {NONE, '\0'};
+
+		/* Genes after the hard length, in turns of the macro genes too, are never searched. */
+		const MacroGenes<N> &macros = MacroGenes<N>::instance();
+		int kept = macros.genes(commands, GENOME_HARD_LENGTH);
+		if(kept < commands.length()) {
+			commands.resize(kept);
+		}
+
+		const FinishingTable<N> &table = FinishingTable<N>::instance();
+		const bool finishing = table.covers(origin);
+
+		RubiksCubeTracker<N> used = origin;
+		double best = used.measure();
+		int length = 0;
+		std::string moves;
+		state = used.getState().hash();
+		for(int i=0; i<=commands.length(); i++) {
+			if(i > 0) {
+				used.move(commands[i-1]);
+
+				double value = used.measure();
+				if(value < best) {
+					best = value;
+					length = i;
+					state = used.getState().hash();
+				}
+			}
+
+			/* Cube close to the solved one is finished with the shortest sequence. */
+			if(finishing == true && table.finish(used, moves) == true) {
+				commands = commands.substr(0, i) + moves;
+				if(commands.length() == 0) {
+					commands = nop;
+				}
+				for(int j=0; j<moves.length(); j++) {
+					used.move(moves[j]);
+				}
+				state = used.getState().hash();
+				return( used.distance() + parsimony(macros.length(commands)) );
+			}
+		}
+
+		double distance = used.distance(best);
+		if(PREFIX_TRUNCATION == true) {
+			if(length == 0) {
+				commands = nop;
+			} else if(length < commands.length()) {
+				commands.resize(length);
+			}
+		} else {
+			distance = used.distance();
+			state = used.getState().hash();
+		}
+
+		return( distance + parsimony(macros.length(commands)) );
 	}
 
-public:
-	static void addRandomCommands(GeneticAlgorithm &ga, const RubiksCube &solved, const RubiksCube &shuffled, int populationSize=0) {
-		for(int p=0; p<populationSize; p++) {
-			RubiksCube mixed;
-			std::string commands = mixed.shuffle(CHROMOSOMES_INITIAL_SIZE);
-			ga.setChromosome( Chromosome(commands,INVALID_FITNESS_VALUE) );
-			ga.setFitness(evaluate(solved, shuffled, commands));
+	/* Fitness under the final distance, by which the chromosomes of islands with different distances are compared. */
+	template<int N>
+	static double judge(const RubiksCubeTracker<N> &origin, std::string &commands) {
+		RubiksCube<N> reference;
+		RubiksCube<N> cube;
+		reference.setState(origin.getReference());
+		reference.setDistanceType(FINAL_DISTANCE_TYPE);
+		cube.setState(origin.getState());
+
+		unsigned long long state = 0;
+		return( evaluate(RubiksCubeTracker<N>(reference, cube), commands, state) );
+	}
+
+	/* The best chromosome is continued by the local search and the result takes the place of the worst one. */
+	template<int N, class Population>
+	static void improve(Population &ga, const RubiksCubeTracker<N> &origin, const MemeticSearch<N> &memetic, std::string &searched) {
+		const Chromosome &best = ga.getBestChromosome();
+		if(best.command == searched) {
+			return;
+		}
+		searched = best.command;
+
+		RubiksCubeTracker<N> tracker = origin;
+		for(int i=0; i<best.command.length(); i++) {
+			tracker.move(best.command[i]);
 		}
+
+		std::string suffix;
+		double distance = INVALID_FITNESS_VALUE;
+		if(memetic.improve(tracker, suffix, distance) == false) {
+			return;
+		}
+
+		/* Continuation is cut at the hard length and scored as any other chromosome. */
+		std::string commands = best.command + suffix;
+		unsigned long long state = 0;
+		double fitness = evaluate(origin, commands, state);
+		ga.replaceWorst( Chromosome(commands,fitness,state) );
 	}
 
-	static void addEmptyCommand(GeneticAlgorithm &ga, const RubiksCube &solved, const RubiksCube &shuffled) {
-		static const char value[] = {NONE, '\0'};
-		ga.setChromosome(Chromosome(std::string(value),INVALID_FITNESS_VALUE));
-		ga.setFitness(evaluate(solved, shuffled, std::string(value)));
+	/* Local searches from the best different chromosomes, one for each thread of the pool. */
+	template<int N, class Population>
+	static void improve(Population &ga, const RubiksCubeTracker<N> &origin, const MemeticSearch<N> &memetic, std::string &searched, TaskPool &pool) {
+		if(ga.getBestChromosome().command == searched) {
+			return;
+		}
+		searched = ga.getBestChromosome().command;
+
+		std::vector< std::pair<double,int> > ranked;
+		for(int i=0; i<ga.size(); i++) {
+			ranked.push_back(std::make_pair(ga.getFitness(i), i));
+		}
+		std::sort(ranked.begin(), ranked.end());
+		ranked.resize(std::min((int)ranked.size(), pool.size()));
+
+		std::vector<std::string> starts(ranked.size());
+		std::vector<std::string> suffixes(ranked.size());
+		std::vector<double> distances(ranked.size(), INVALID_FITNESS_VALUE);
+		std::vector<char> improved(ranked.size(), false);
+		for(int k=0; k<ranked.size(); k++) {
+			starts[k] = ga.getChromosome(ranked[k].second).command;
+			pool.submit([&origin, &memetic, &starts, &suffixes, &distances, &improved, k]() {
+				RubiksCubeTracker<N> tracker = origin;
+				for(int i=0; i<starts[k].length(); i++) {
+					tracker.move(starts[k][i]);
+				}
+				improved[k] = memetic.improve(tracker, suffixes[k], distances[k]);
+			});
+		}
+		pool.wait();
+
+		for(int k=0; k<ranked.size(); k++) {
+			if(improved[k] == true) {
+				std::string commands = starts[k] + suffixes[k];
+				unsigned long long state = 0;
+				double fitness = evaluate(origin, commands, state);
+				ga.replaceWorst( Chromosome(commands,fitness,state) );
+			}
+		}
+	}
+
+	/* Improvements of the island are published and the elites of the other islands are taken with their fitness for this cube. */
+	template<int N, class Population>
+	static void share(Population &ga, const RubiksCubeTracker<N> &origin, HallOfFame &hall, double &published) {
+		const Chromosome &best = ga.getBestChromosome();
+		if(best.fitness < published) {
+			published = best.fitness;
+
+			std::string commands = MacroGenes<N>::instance().expand(best.command);
+			double fitness = (ISLAND_METRICS == true) ? judge(origin, commands) : best.fitness;
+			hall.publish( Chromosome(commands,fitness) );
+		}
+
+		std::vector<Chromosome> elites;
+		hall.pull(elites);
+		for(int i=0; i<elites.size(); i++) {
+			std::string commands = elites[i].command;
+			unsigned long long state = 0;
+			double fitness = evaluate(origin, commands, state);
+			if(fitness < ga.getWorstChromosome().fitness) {
+				ga.replaceWorst( Chromosome(commands,fitness,state) );
+			}
+		}
 	}
 
-	static void optimize(GeneticAlgorithm &ga, RubiksCube &solved, RubiksCube &shuffled, long epoches=0) {
-		for(long e=0L; e<epoches*ga.size(); e++) {
+	/* Best chromosome of the island goes to the next island and the migrants are taken with their fitness for this cube. */
+	template<int N, class Population>
+	static void migrate(Population &ga, const RubiksCubeTracker<N> &origin, NodeMigration &migration, bool far) {
+		std::vector<Chromosome> migrants;
+		migration.exchange(Chromosome(MacroGenes<N>::instance().expand(ga.getBestChromosome().command),ga.getBestFitness()), far, migrants);
+		for(int i=0; i<migrants.size(); i++) {
+			std::string commands = migrants[i].command;
+			unsigned long long state = 0;
+			double fitness = evaluate(origin, commands, state);
+			if(fitness < ga.getWorstChromosome().fitness) {
+				ga.replaceWorst( Chromosome(commands,fitness,state) );
+			}
+		}
+	}
+
+	/* Local search and exchanges with the other islands after the epoch. */
+	template<int N, class Population>
+	static void periodic(Population &ga, const RubiksCubeTracker<N> &origin, long e, const MemeticSearch<N> *memetic, HallOfFame *hall, NodeMigration *migration, std::string &searched, double &published, TaskPool *pool=NULL) {
+		if(memetic != NULL && MEMETIC_INTERVAL > 0 && (e+1)%MEMETIC_INTERVAL == 0) {
+			if(pool != NULL) {
+				improve(ga, origin, *memetic, searched, *pool);
+			} else {
+				improve(ga, origin, *memetic, searched);
+			}
+		}
+
+		if(hall != NULL && HALL_OF_FAME_INTERVAL > 0 && (e+1)%HALL_OF_FAME_INTERVAL == 0) {
+			share(ga, origin, *hall, published);
+		}
+
+		if(migration != NULL && NODE_MIGRATION_INTERVAL > 0 && (e+1)%NODE_MIGRATION_INTERVAL == 0) {
+			migrate(ga, origin, *migration, LEADER_MIGRATION_INTERVAL > 0 && (e+1)%LEADER_MIGRATION_INTERVAL == 0);
+		}
+	}
+
+	/* Epoch in which the offspring are made first and then checked for clones and evaluated by the pool, so the threads done with short chromosomes take the long ones. */
+	template<int N>
+	static void generation(GeneticAlgorithm &ga, const RubiksCubeTracker<N> &origin, TaskPool &pool) {
+		struct Offspring {
+			int index;
+			std::string commands;
+			double fitness;
+			unsigned long long state;
+			bool kept;
+		};
+
+		/* Population does not change until all offspring are evaluated. */
+		std::vector<Offspring> offspring(ga.size());
+		for(int i=0; i<offspring.size(); i++) {
 			ga.selection();
 			ga.crossover();
 			ga.mutation();
 			ga.reduction();
-			int index = ga.getResultIndex();
-			ga.setFitness(evaluate(solved, shuffled, ga.getChromosome(index).command), index);
+
+			offspring[i].index = ga.getResultIndex();
+			offspring[i].commands = ga.getChromosome(offspring[i].index).command;
+			offspring[i].kept = false;
+			ga.reject();
+		}
+
+		for(int i=0; i<offspring.size(); i++) {
+			pool.submit([&ga, &origin, &offspring, i]() {
+				Offspring &child = offspring[i];
+				for(int t=0; t<DUPLICATE_RETRIES && ga.contains(Chromosome(child.commands,INVALID_FITNESS_VALUE))==true; t++) {
+					GeneticAlgorithm::mutate(child.commands);
+					GeneticAlgorithm::reduce(child.commands);
+				}
+				if(ga.contains(Chromosome(child.commands,INVALID_FITNESS_VALUE)) == true) {
+					return;
+				}
+
+				child.fitness = evaluate(origin, child.commands, child.state);
+				child.kept = (ga.contains(Chromosome(child.commands,child.fitness,child.state)) == false);
+			});
+		}
+		pool.wait();
+
+		/* Offspring which are clones of each other are dropped here. */
+		for(int i=0; i<offspring.size(); i++) {
+			Chromosome chromosome(offspring[i].commands, offspring[i].fitness, offspring[i].state);
+			if(offspring[i].kept == true && ga.contains(chromosome) == false) {
+				ga.setChromosome(chromosome, offspring[i].index);
+			}
+		}
+	}
+
+	/* Single steady state step on the shared population. The offspring is dropped when another thread changed its place meanwhile. */
+	template<int N>
+	static void step(SharedPopulation &population, const RubiksCubeTracker<N> &origin) {
+		const int size = population.size();
+		const int percent = GeneticAlgorithm::kind();
+
+		int result = 0;
+		int first = 0;
+		int second = 0;
+		do {
+			result = GeneticAlgorithm::random() % size;
+			first = GeneticAlgorithm::random() % size;
+			second = GeneticAlgorithm::random() % size;
+		} while(result==first || result==second || (result == population.getBestIndex() && GeneticAlgorithm::KEEP_ELITE==true) || GeneticAlgorithm::fits(percent, population.getFitness(result), population.getFitness(first), population.getFitness(second)) == false);
+
+		const unsigned long version = population.getVersion(result);
+		Chromosome mother;
+		Chromosome father;
+		if(version%2 == 1 || population.read(first, mother) == false || population.read(second, father) == false || mother.command.length() == 0 || father.command.length() == 0) {
+			return;
+		}
+
+		std::string commands = GeneticAlgorithm::cross(mother.command, father.command);
+		GeneticAlgorithm::mutate(commands);
+		GeneticAlgorithm::reduce(commands);
+		for(int t=0; t<DUPLICATE_RETRIES && population.contains(Chromosome(commands,INVALID_FITNESS_VALUE))==true; t++) {
+			GeneticAlgorithm::mutate(commands);
+			GeneticAlgorithm::reduce(commands);
+		}
+		if(population.contains(Chromosome(commands,INVALID_FITNESS_VALUE)) == true) {
+			return;
+		}
+
+		unsigned long long state = 0;
+		double fitness = evaluate(origin, commands, state);
+		Chromosome offspring(commands, fitness, state);
+		if(population.contains(offspring) == true) {
+			return;
+		}
+
+		population.replace(result, version, offspring);
+	}
+
+	/* Epoches of one of the threads which evolve the same population, each with its own random numbers. */
+	template<int N>
+	static long evolve(SharedPopulation &population, const RubiksCubeTracker<N> &origin, unsigned seed, long epoches, double seconds, std::chrono::steady_clock::time_point start, std::atomic<bool> &stop, const MemeticSearch<N> *memetic, HallOfFame *hall, NodeMigration *migration) {
+		std::minstd_rand engine(seed);
+		GeneticAlgorithm::setEngine(&engine);
+
+		/* Steps of all threads in an epoch replace the population once. */
+		const int steps = (population.size()+PANMICTIC_THREADS-1) / PANMICTIC_THREADS;
+		std::string searched;
+		double published = INVALID_FITNESS_VALUE;
+
+		long e = 0L;
+		for(; e<epoches && stop.load()==false; e++) {
+			for(int i=0; i<steps; i++) {
+				step(population, origin);
+			}
+
+			periodic(population, origin, e, memetic, hall, migration, searched, published);
+
+			if(seconds > 0 && std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count() >= seconds) {
+				stop.store(true);
+				e++;
+				break;
+			}
+		}
+
+		GeneticAlgorithm::setEngine(NULL);
+		return( e );
+	}
+
+	/* All threads evolve one population. Only the calling thread does the local search and the migration, since only it uses MPI. */
+	template<int N>
+	static long panmictic(GeneticAlgorithm &ga, const RubiksCubeTracker<N> &origin, long epoches, double seconds, std::chrono::steady_clock::time_point start, const MemeticSearch<N> *memetic, HallOfFame *hall, NodeMigration *migration) {
+		SharedPopulation population(ga);
+		std::atomic<bool> stop(false);
+
+		std::vector<unsigned> seeds;
+		for(int t=0; t<PANMICTIC_THREADS; t++) {
+			seeds.push_back( rand() );
+		}
+
+		std::vector<std::thread> threads;
+		for(int t=1; t<PANMICTIC_THREADS; t++) {
+			threads.push_back(std::thread([&population, &origin, &stop, &seeds, t, epoches, seconds, start]() {
+				evolve<N>(population, origin, seeds[t], epoches, seconds, start, stop, NULL, NULL, NULL);
+			}));
+		}
+
+		long e = evolve<N>(population, origin, seeds[0], epoches, seconds, start, stop, memetic, hall, migration);
+		for(int t=0; t<threads.size(); t++) {
+			threads[t].join();
+		}
+
+		population.store(ga);
+		return( e );
+	}
+
+	GeneticAlgorithmOptimizer() {
+	}
+
+public:
+	template<int N>
+	static void addRandomCommands(GeneticAlgorithm &ga, const RubiksCube<N> &solved, const RubiksCube<N> &shuffled, int populationSize=0) {
+		RubiksCubeTracker<N> origin(solved, shuffled);
+
+		for(int p=0; p<populationSize; p++) {
+			/* Clones are made again with more commands, since the short chromosomes are soon used up. */
+			std::string commands;
+			double fitness = INVALID_FITNESS_VALUE;
+			unsigned long long state = 0;
+			for(int t=0; t<=DUPLICATE_RETRIES; t++) {
+				RubiksCube<N> mixed;
+				commands = mixed.shuffle(CHROMOSOMES_INITIAL_SIZE+t);
+				fitness = evaluate(origin, commands, state);
+				if(ga.contains(Chromosome(commands,fitness,state)) == false) {
+					break;
+				}
+			}
+			ga.setChromosome( Chromosome(commands,INVALID_FITNESS_VALUE,state) );
+			ga.setFitness(fitness);
+		}
+	}
+
+	/* Fitness of a chromosome which comes from an island with another distance or another cube. */
+	template<int N>
+	static Chromosome rescore(const Chromosome &chromosome, const RubiksCube<N> &solved, const RubiksCube<N> &shuffled) {
+		std::string commands = chromosome.command;
+		unsigned long long state = 0;
+		double fitness = evaluate(RubiksCubeTracker<N>(solved, shuffled), commands, state);
+		return( Chromosome(commands,fitness,state) );
+	}
+
+	template<int N>
+	static void rescore(GeneticAlgorithm &ga, const RubiksCube<N> &solved, const RubiksCube<N> &shuffled) {
+		GeneticAlgorithm result;
+		for(int i=0; i<ga.size(); i++) {
+			result.setChromosome( rescore(ga.getChromosome(i), solved, shuffled) );
+		}
+		ga = result;
+	}
+
+	/* Known paths, as the solutions of earlier runs, take the places of the worse chromosomes. */
+	template<int N>
+	static void addKnownCommands(GeneticAlgorithm &ga, const RubiksCube<N> &solved, const RubiksCube<N> &shuffled, const std::vector<std::string> &commands) {
+		for(int i=0; i<commands.size(); i++) {
+			Chromosome chromosome = rescore(Chromosome(commands[i],INVALID_FITNESS_VALUE), solved, shuffled);
+			if(ga.size() > 0 && chromosome.fitness < ga.getWorstChromosome().fitness) {
+				ga.replaceWorst(chromosome);
+			}
+		}
+	}
+
+	template<int N>
+	static void addEmptyCommand(GeneticAlgorithm &ga, const RubiksCube<N> &solved, const RubiksCube<N> &shuffled) {
+		static const char value[] = {NONE, '\0'};
+		std::string commands = value;
+		unsigned long long state = 0;
+		double fitness = evaluate(RubiksCubeTracker<N>(solved, shuffled), commands, state);
+		ga.setChromosome(Chromosome(commands,INVALID_FITNESS_VALUE,state));
+		ga.setFitness(fitness);
+	}
+
+	/* Returns the number of completed epoches, which is less than requested if the time budget is over. */
+	template<int N>
+	static long optimize(GeneticAlgorithm &ga, RubiksCube<N> &solved, RubiksCube<N> &shuffled, long epoches=0, double seconds=0.0, const MemeticSearch<N> *memetic=NULL, HallOfFame *hall=NULL, NodeMigration *migration=NULL) {
+		const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		const RubiksCubeTracker<N> origin(solved, shuffled);
+		const MacroGenes<N> &macros = MacroGenes<N>::instance();
+		std::string searched;
+		double published = INVALID_FITNESS_VALUE;
+
+		/* Same cubes with shorter chromosomes. */
+		if(macros.getSymbols() != "") {
+			for(int i=0; i<ga.size(); i++) {
+				ga.setChromosome(Chromosome(macros.compress(ga.getChromosome(i).command),ga.getFitness(i),ga.getChromosome(i).state), i);
+			}
+		}
+
+		long e = 0L;
+		if(PANMICTIC_THREADS > 1 && ga.size() > 2 && SharedPopulation::holds(ga) == true) {
+			e = panmictic(ga, origin, epoches, seconds, start, memetic, hall, migration);
+		} else if(EVALUATION_THREADS > 1) {
+			TaskPool &pool = TaskPool::instance();
+			for(; e<epoches; e++) {
+				generation(ga, origin, pool);
+				periodic(ga, origin, e, memetic, hall, migration, searched, published, &pool);
+
+				if(seconds > 0 && std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count() >= seconds) {
+					e++;
+					break;
+				}
+			}
+		} else {
+			for(; e<epoches; e++) {
+				for(int i=0; i<ga.size(); i++) {
+					ga.selection();
+					ga.crossover();
+					ga.mutation();
+					ga.reduction();
+
+					/* Clones are mutated again and dropped when they stay clones, so they are never evaluated. */
+					for(int t=0; t<DUPLICATE_RETRIES && ga.duplicate()==true; t++) {
+						ga.mutation();
+						ga.reduction();
+					}
+					if(ga.duplicate() == true) {
+						ga.reject();
+						continue;
+					}
+
+					int index = ga.getResultIndex();
+					std::string commands = ga.getChromosome(index).command;
+					unsigned long long state = 0;
+					double fitness = evaluate(origin, commands, state);
+
+					/* Other commands which give the same cube take no place in the population. */
+					if(ga.duplicate(state) == true) {
+						ga.reject();
+						continue;
+					}
+					ga.setChromosome(Chromosome(commands,fitness,state), index);
+				}
+
+				periodic(ga, origin, e, memetic, hall, migration, searched, published);
+
+				if(seconds > 0 && std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count() >= seconds) {
+					e++;
+					break;
+				}
+			}
+		}
+
+		/* Other islands and the solution know only the moves. */
+		if(macros.getSymbols() != "") {
+			for(int i=0; i<ga.size(); i++) {
+				ga.setChromosome(Chromosome(macros.expand(ga.getChromosome(i).command),ga.getFitness(i),ga.getChromosome(i).state), i);
+			}
 		}
 
 		shuffled.execute(ga.getChromosome(ga.getBestIndex()).command);
+
+		return( e );
 	}
 };
 
@@ -0,0 +1,200 @@
+#ifndef HALLOFFAME_H_INCLUDED
+#define HALLOFFAME_H_INCLUDED
+
+#include "Chromosome.h"
+
+/*
+ * Best chromosomes of all workers in a one-sided window on the root. Workers
+ * publish their improvements and pull the elites at any time with remote
+ * memory access, without messages to the root and without waiting for the
+ * end of the round.
+ *
+ * The best fitness is changed with an atomic minimum, so only a chromosome
+ * better than all published ones is written. Distances are not negative, so
+ * the bits of the fitness as a 64-bit integer keep the order of the values.
+ * Each improvement takes the next of the slots in turn. A slot which is read
+ * while it is written does not match its hash and is skipped.
+ *
+ * The window is made once over all ranks, since windows made at the same
+ * time by several groups of processes are not reliable with some MPI
+ * libraries. Every rank has the memory for a hall of fame and the root of
+ * each solving group uses its own memory for the group.
+ *
+ * Layout of the memory of a rank: best fitness, number of improvements, slots.
+ */
+class HallOfFame {
+private:
+	struct Header {
+		long long best;
+		long long count;
+	};
+
+	struct Entry {
+		long long fitness;
+		unsigned long long genome;
+		int length;
+		char command[HALL_OF_FAME_LENGTH];
+	};
+
+	MPI_Comm comm;
+
+	MPI_Win window;
+
+	char *memory;
+
+	/* Rank in the window of the root of the group. */
+	int root;
+
+	bool opened;
+
+	static long long bits(double fitness) {
+		long long value = 0;
+		memcpy(&value, &fitness, sizeof(value));
+		return( value );
+	}
+
+	static double value(long long bits) {
+		double fitness = 0;
+		memcpy(&fitness, &bits, sizeof(fitness));
+		return( fitness );
+	}
+
+public:
+	HallOfFame() {
+		comm = MPI_COMM_NULL;
+		window = MPI_WIN_NULL;
+		memory = NULL;
+		root = 0;
+		opened = false;
+	}
+
+	/* Collective over all ranks which can take part in any group. */
+	void create(MPI_Comm world) {
+		MPI_Win_allocate(sizeof(Header) + HALL_OF_FAME_SIZE*sizeof(Entry), 1, MPI_INFO_NULL, world, &memory, &window);
+		MPI_Win_lock_all(0, window);
+	}
+
+	/* Collective over all ranks which can take part in any group. */
+	void free() {
+		if(window == MPI_WIN_NULL) {
+			return;
+		}
+
+		MPI_Win_unlock_all(window);
+		MPI_Win_free(&window);
+	}
+
+	bool isOpen() const {
+		return( opened );
+	}
+
+	/* Collective over the group. The hall of fame of the group starts empty. */
+	void open(MPI_Comm comm, int root) {
+		if(window == MPI_WIN_NULL) {
+			return;
+		}
+
+		MPI_Group group;
+		MPI_Group all;
+		MPI_Comm_group(comm, &group);
+		MPI_Win_get_group(window, &all);
+		MPI_Group_translate_ranks(group, 1, &root, all, &this->root);
+		MPI_Group_free(&group);
+		MPI_Group_free(&all);
+
+		int rank = 0;
+		MPI_Comm_rank(comm, &rank);
+		if(rank == root) {
+			memset(memory, 0, sizeof(Header) + HALL_OF_FAME_SIZE*sizeof(Entry));
+			((Header*)memory)->best = bits(INVALID_FITNESS_VALUE);
+			MPI_Win_sync(window);
+		}
+
+		this->comm = comm;
+		MPI_Barrier(comm);
+		opened = true;
+	}
+
+	/* Collective over the group, so no access is left when the hall of fame is opened again. */
+	void close() {
+		if(opened == false) {
+			return;
+		}
+
+		MPI_Barrier(comm);
+		opened = false;
+	}
+
+	double getBest() {
+		long long current = 0;
+		MPI_Fetch_and_op(NULL, &current, MPI_LONG_LONG, root, offsetof(Header,best), MPI_NO_OP, window);
+		MPI_Win_flush(root, window);
+		return( value(current) );
+	}
+
+	/* False when the chromosome is not better than the published ones or it is too long. */
+	bool publish(const Chromosome &chromosome) {
+		if(opened == false || chromosome.command.length() > HALL_OF_FAME_LENGTH || chromosome.fitness < 0) {
+			return( false );
+		}
+
+		/* Atomic minimum, which does the same as a loop of compare-and-swap in a single access. */
+		const long long proposed = bits(chromosome.fitness);
+		long long previous = 0;
+		MPI_Fetch_and_op(&proposed, &previous, MPI_LONG_LONG, root, offsetof(Header,best), MPI_MIN, window);
+		MPI_Win_flush(root, window);
+		if(proposed >= previous) {
+			return( false );
+		}
+
+		const long long one = 1;
+		long long ticket = 0;
+		MPI_Fetch_and_op(&one, &ticket, MPI_LONG_LONG, root, offsetof(Header,count), MPI_SUM, window);
+		MPI_Win_flush(root, window);
+
+		Entry entry;
+		memset(&entry, 0, sizeof(entry));
+		entry.fitness = proposed;
+		entry.genome = chromosome.genome;
+		entry.length = chromosome.command.length();
+		memcpy(entry.command, chromosome.command.data(), entry.length);
+
+		MPI_Aint offset = sizeof(Header) + (ticket%HALL_OF_FAME_SIZE)*sizeof(Entry);
+		MPI_Put(&entry, sizeof(entry), MPI_BYTE, root, offset, sizeof(entry), MPI_BYTE, window);
+		MPI_Win_flush(root, window);
+
+		return( true );
+	}
+
+	/* Published chromosomes, best first. */
+	void pull(std::vector<Chromosome> &elites) {
+		elites.clear();
+		if(opened == false) {
+			return;
+		}
+
+		std::vector<Entry> entries(HALL_OF_FAME_SIZE);
+		MPI_Get(&entries[0], entries.size()*sizeof(Entry), MPI_BYTE, root, sizeof(Header), entries.size()*sizeof(Entry), MPI_BYTE, window);
+		MPI_Win_flush(root, window);
+
+		for(int i=0; i<entries.size(); i++) {
+			if(entries[i].length <= 0 || entries[i].length > HALL_OF_FAME_LENGTH) {
+				continue;
+			}
+
+			Chromosome chromosome(std::string(entries[i].command, entries[i].length), value(entries[i].fitness));
+			if(chromosome.genome != entries[i].genome) {
+				continue;
+			}
+			elites.push_back(chromosome);
+		}
+
+		for(int i=1; i<elites.size(); i++) {
+			for(int j=i; j>0 && elites[j].fitness<elites[j-1].fitness; j--) {
+				std::swap(elites[j], elites[j-1]);
+			}
+		}
+	}
+};
+
+#endif
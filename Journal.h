@@ -0,0 +1,286 @@
+#ifndef JOURNAL_H_INCLUDED
+#define JOURNAL_H_INCLUDED
+
+#include "GeneticAlgorithm.h"
+
+/*
+ * Append-only file of the improvements of a rank, mapped in memory, so an
+ * append is only a copy to the mapping and nothing is lost when the process
+ * dies. Each entry has the distance, the moves from the scramble packed in
+ * a few bits each, the rank, the experiment, the round and the wall time.
+ *
+ * An entry becomes visible when its size is stored, after all its other
+ * bytes, and it has a checksum, so readers of a running or crashed journal
+ * stop at the first entry which is not complete. The file grows when it is
+ * full. The alphabet of the genes is in the header of the file, so other
+ * builds can read it.
+ */
+class Journal {
+public:
+	struct Record {
+		double fitness;
+
+		/* Seconds since the epoch. */
+		double time;
+
+		long long round;
+		int rank;
+		int phase;
+		std::string commands;
+	};
+
+private:
+	static const long long MAGIC = 0x4C4E52554F4A4147LL;
+
+	struct Header {
+		long long magic;
+		int bits;
+		int reserved;
+		char alphabet[64];
+	};
+
+	struct Entry {
+		/* Bytes of the whole entry, stored last and zero for the end of the journal. */
+		unsigned int size;
+		unsigned int checksum;
+		double fitness;
+		double time;
+		long long round;
+		int rank;
+		int phase;
+		int length;
+		int reserved;
+	};
+
+	int file;
+
+	char *memory;
+
+	/* Bytes of the file and of the mapping. */
+	size_t capacity;
+
+	/* Offset of the next entry. */
+	size_t end;
+
+	static unsigned int checksum(const char bytes[], size_t size) {
+		unsigned int result = 2166136261U;
+		for(size_t i=0; i<size; i++) {
+			result = (result ^ (unsigned char)bytes[i]) * 16777619U;
+		}
+		return( result );
+	}
+
+	/* Smallest number of bits for the index of any gene. */
+	static int width(const std::string &alphabet) {
+		int bits = 1;
+		while((1 << bits) < alphabet.length()) {
+			bits++;
+		}
+		return( bits );
+	}
+
+	/* Offset after the entry at the given offset, zero when there is no complete entry there. */
+	static size_t next(const char memory[], size_t size, size_t offset) {
+		if(offset + sizeof(Entry) > size) {
+			return( 0 );
+		}
+
+		const Entry *entry = (const Entry*)(memory + offset);
+		if(entry->size < sizeof(Entry) || entry->size%8 != 0 || offset + entry->size > size) {
+			return( 0 );
+		}
+		if(checksum(memory+offset+2*sizeof(unsigned int), entry->size-2*sizeof(unsigned int)) != entry->checksum) {
+			return( 0 );
+		}
+
+		return( offset + entry->size );
+	}
+
+	bool map(size_t size) {
+		if(memory != NULL) {
+			munmap(memory, capacity);
+			memory = NULL;
+		}
+
+		if(ftruncate(file, size) != 0) {
+			return( false );
+		}
+
+		void *address = mmap(NULL, size, PROT_READ|PROT_WRITE, MAP_SHARED, file, 0);
+		if(address == MAP_FAILED) {
+			return( false );
+		}
+
+		memory = (char*)address;
+		capacity = size;
+		return( true );
+	}
+
+public:
+	Journal() {
+		file = -1;
+		memory = NULL;
+		capacity = 0;
+		end = 0;
+	}
+
+	~Journal() {
+		close();
+	}
+
+	bool isOpen() const {
+		return( memory != NULL );
+	}
+
+	/* New entries are put after the complete entries of the file. */
+	bool open(const std::string &name) {
+		close();
+
+		file = ::open(name.c_str(), O_RDWR|O_CREAT, 0644);
+		if(file == -1) {
+			return( false );
+		}
+
+		struct stat status;
+		if(fstat(file, &status) != 0 || map(std::max((size_t)status.st_size, (size_t)JOURNAL_CAPACITY)) == false) {
+			close();
+			return( false );
+		}
+
+		/* Journal of another cube is not overwritten. */
+		const std::string &alphabet = GeneticAlgorithm::getAlphabet();
+		Header *header = (Header*)memory;
+		if(header->magic != MAGIC) {
+			memset(memory, 0, capacity);
+			header->bits = width(alphabet);
+			strncpy(header->alphabet, alphabet.c_str(), sizeof(header->alphabet)-1);
+			std::atomic_thread_fence(std::memory_order_release);
+			header->magic = MAGIC;
+		}
+		if(header->bits != width(alphabet) || std::string(header->alphabet, strnlen(header->alphabet, sizeof(header->alphabet))) != alphabet) {
+			close();
+			return( false );
+		}
+
+		end = sizeof(Header);
+		for(size_t offset=end; (offset=next(memory, capacity, end)) != 0;) {
+			end = offset;
+		}
+
+		return( true );
+	}
+
+	void close() {
+		if(memory != NULL) {
+			munmap(memory, capacity);
+			memory = NULL;
+		}
+		if(file != -1) {
+			::close(file);
+			file = -1;
+		}
+		capacity = 0;
+		end = 0;
+	}
+
+	/* Genes which are not in the alphabet, as the no-operations, are not stored. */
+	bool append(double fitness, int rank, int phase, long long round, const std::string &commands) {
+		if(memory == NULL) {
+			return( false );
+		}
+
+		const std::string &alphabet = GeneticAlgorithm::getAlphabet();
+		const int bits = width(alphabet);
+
+		std::vector<int> genes;
+		for(int i=0; i<commands.length(); i++) {
+			std::string::size_type index = alphabet.find(commands[i]);
+			if(index != std::string::npos) {
+				genes.push_back(index);
+			}
+		}
+
+		size_t size = sizeof(Entry) + (genes.size()*bits+7)/8;
+		size = (size+7) / 8 * 8;
+
+		/* The next entry stays zero, so the readers stop there. */
+		if(end + size + sizeof(Entry) > capacity && map(2*capacity + size) == false) {
+			return( false );
+		}
+
+		Entry *entry = (Entry*)(memory + end);
+		unsigned char *packed = (unsigned char*)(entry + 1);
+		memset(packed, 0, size-sizeof(Entry));
+		for(int g=0; g<genes.size(); g++) {
+			for(int b=0; b<bits; b++) {
+				if((genes[g] >> b) & 1) {
+					packed[(g*bits+b)/8] |= 1 << ((g*bits+b)%8);
+				}
+			}
+		}
+
+		entry->fitness = fitness;
+		entry->time = std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+		entry->round = round;
+		entry->rank = rank;
+		entry->phase = phase;
+		entry->length = genes.size();
+		entry->reserved = 0;
+		entry->checksum = checksum(memory+end+2*sizeof(unsigned int), size-2*sizeof(unsigned int));
+		((Entry*)(memory + end + size))->size = 0;
+
+		std::atomic_thread_fence(std::memory_order_release);
+		entry->size = size;
+		end += size;
+
+		return( true );
+	}
+
+	/* Complete entries of a journal, also while it is written by a running process. */
+	static bool read(const std::string &name, std::vector<Record> &records) {
+		std::ifstream in(name.c_str(), std::ios::binary);
+		if(!in) {
+			return( false );
+		}
+
+		std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+		if(bytes.size() < sizeof(Header)) {
+			return( false );
+		}
+
+		const Header *header = (const Header*)&bytes[0];
+		if(header->magic != MAGIC) {
+			return( false );
+		}
+		std::string alphabet(header->alphabet, strnlen(header->alphabet, sizeof(header->alphabet)));
+
+		for(size_t offset=sizeof(Header), following=0; (following=next(&bytes[0], bytes.size(), offset)) != 0; offset=following) {
+			const Entry *entry = (const Entry*)&bytes[offset];
+			const unsigned char *packed = (const unsigned char*)(entry + 1);
+			if(entry->length < 0 || (entry->length*(size_t)header->bits+7)/8 > entry->size-sizeof(Entry)) {
+				break;
+			}
+
+			Record record;
+			record.fitness = entry->fitness;
+			record.time = entry->time;
+			record.round = entry->round;
+			record.rank = entry->rank;
+			record.phase = entry->phase;
+			for(int g=0; g<entry->length; g++) {
+				int index = 0;
+				for(int b=0; b<header->bits; b++) {
+					index |= ((packed[(g*header->bits+b)/8] >> ((g*header->bits+b)%8)) & 1) << b;
+				}
+				if(index < alphabet.length()) {
+					record.commands += alphabet[index];
+				}
+			}
+			records.push_back(record);
+		}
+
+		return( true );
+	}
+};
+
+#endif
@@ -0,0 +1,198 @@
+#ifndef MACROGENES_H_INCLUDED
+#define MACROGENES_H_INCLUDED
+
+#include "RubiksSide.h"
+#include "RubiksCube.h"
+#include "RubiksCubeMoves.h"
+
+/*
+ * Frequent sequences of moves from the best chromosomes, each written as a
+ * single gene. A macro gene is composed into one move of the move tables, so
+ * it is evaluated with a single table application, and mutation can put a
+ * whole sequence at once.
+ *
+ * Macro genes are used only inside the optimization of an island. Chromosomes
+ * are compressed when the optimization starts and expanded back to turns when
+ * it ends, so the migrating chromosomes and the solutions have only turns.
+ *
+ * Definitions are the sequences separated with spaces, in the order of the
+ * characters in MACRO_SYMBOLS.
+ */
+template<int N>
+class MacroGenes {
+private:
+	/* Sequence of turns for each macro gene character and empty strings for the other characters. */
+	std::string sequences[256];
+
+	std::string symbols;
+
+	MacroGenes() {
+		symbols = "";
+	}
+
+	/* Sequences which can not be a useful macro gene. */
+	static bool valid(const std::string &sequence) {
+		const std::string &alphabet = RubiksCube<N>::alphabet();
+
+		for(int i=0; i<sequence.length(); i++) {
+			if(alphabet.find(sequence[i]) == std::string::npos) {
+				return( false );
+			}
+
+			/* Four turns of a side give the same cube. */
+			if(i >= 3 && sequence[i] == sequence[i-1] && sequence[i] == sequence[i-2] && sequence[i] == sequence[i-3]) {
+				return( false );
+			}
+		}
+
+		return( true );
+	}
+
+public:
+	static MacroGenes<N>& instance() {
+		static MacroGenes<N> macros;
+		return( macros );
+	}
+
+	/* Characters of the macro genes in use. */
+	const std::string& getSymbols() const {
+		return( symbols );
+	}
+
+	/* Macro genes from their definitions, which replace the previous ones. */
+	void install(const std::string &definitions) {
+		static const std::string characters = MACRO_SYMBOLS;
+
+		for(int i=0; i<symbols.length(); i++) {
+			sequences[(unsigned char)symbols[i]] = "";
+		}
+		symbols = "";
+
+		std::vector<std::string> list;
+		std::istringstream in(definitions);
+		std::string sequence;
+		while(in >> sequence && list.size() < MACRO_COUNT && list.size() < characters.length()) {
+			sequences[(unsigned char)characters[list.size()]] = sequence;
+			symbols += characters[list.size()];
+			list.push_back(sequence);
+		}
+
+		RubiksCubeMoves<N>::define(symbols, list);
+	}
+
+	/* Commands with the macro genes replaced by their turns. */
+	std::string expand(const std::string &commands) const {
+		if(symbols == "") {
+			return( commands );
+		}
+
+		std::string result = "";
+		for(int i=0; i<commands.length(); i++) {
+			const std::string &sequence = sequences[(unsigned char)commands[i]];
+			if(sequence == "") {
+				result += commands[i];
+			} else {
+				result += sequence;
+			}
+		}
+
+		return( result );
+	}
+
+	/* Turns for which the commands stand. */
+	int length(const std::string &commands) const {
+		if(symbols == "") {
+			return( commands.length() );
+		}
+
+		int result = 0;
+		for(int i=0; i<commands.length(); i++) {
+			const std::string &sequence = sequences[(unsigned char)commands[i]];
+			result += (sequence == "") ? 1 : sequence.length();
+		}
+
+		return( result );
+	}
+
+	/* Genes at the start of the commands which stand for at most the given turns. */
+	int genes(const std::string &commands, int turns) const {
+		if(symbols == "") {
+			return( std::min((int)commands.length(), turns) );
+		}
+
+		int result = 0;
+		for(int length=0; result<commands.length(); result++) {
+			const std::string &sequence = sequences[(unsigned char)commands[result]];
+			length += (sequence == "") ? 1 : sequence.length();
+			if(length > turns) {
+				break;
+			}
+		}
+
+		return( result );
+	}
+
+	/* Commands with the longest sequences of turns replaced by macro genes, from left to right. */
+	std::string compress(const std::string &commands) const {
+		if(symbols == "") {
+			return( commands );
+		}
+
+		std::string result = "";
+		for(int i=0; i<commands.length();) {
+			int best = -1;
+			for(int m=0; m<symbols.length(); m++) {
+				const std::string &sequence = sequences[(unsigned char)symbols[m]];
+				if(commands.compare(i, sequence.length(), sequence) == 0 && (best == -1 || sequence.length() > sequences[(unsigned char)symbols[best]].length())) {
+					best = m;
+				}
+			}
+
+			if(best == -1) {
+				result += commands[i];
+				i++;
+			} else {
+				result += symbols[best];
+				i += sequences[(unsigned char)symbols[best]].length();
+			}
+		}
+
+		return( result );
+	}
+
+	/* Definitions of the sequences which save the most genes in the given chromosomes. */
+	static std::string mine(const std::vector<std::string> &chromosomes) {
+		std::map<std::string,int> counts;
+		for(int c=0; c<chromosomes.size(); c++) {
+			for(int length=2; length<=MACRO_LENGTH; length++) {
+				for(int i=0; i+length<=chromosomes[c].length(); i++) {
+					std::string sequence = chromosomes[c].substr(i, length);
+					if(valid(sequence) == true) {
+						counts[sequence]++;
+					}
+				}
+			}
+		}
+
+		/* Sequences seen once are not frequent. Equal savings are ordered by the sequences, so all runs give the same result. */
+		std::vector< std::pair<int,std::string> > ranked;
+		for(std::map<std::string,int>::const_iterator i=counts.begin(); i!=counts.end(); i++) {
+			if(i->second >= 2) {
+				ranked.push_back(std::make_pair(-i->second*((int)i->first.length()-1), i->first));
+			}
+		}
+		std::sort(ranked.begin(), ranked.end());
+
+		std::string result = "";
+		for(int r=0; r<ranked.size() && r<MACRO_COUNT; r++) {
+			if(r > 0) {
+				result += " ";
+			}
+			result += ranked[r].second;
+		}
+
+		return( result );
+	}
+};
+
+#endif
@@ -0,0 +1,105 @@
+#ifndef MEMETICSEARCH_H_INCLUDED
+#define MEMETICSEARCH_H_INCLUDED
+
+#include "RubiksSide.h"
+#include "RubiksCubeTracker.h"
+
+/*
+ * Local search which continues a chromosome with a few more moves. It is an
+ * iterative deepening depth-first search, as IDA*, with the distance as the
+ * heuristic: a branch is cut when even the largest change of each remaining
+ * move can not bring it below the best distance found so far.
+ *
+ * The state of a search is kept on the stack, so one object can be used from
+ * many threads at the same time.
+ */
+template<int N>
+class MemeticSearch {
+private:
+	struct Context {
+		long nodes;
+		double best;
+		std::string path;
+		std::string suffix;
+	};
+
+	int depth;
+
+	/* Moves tried in a single call. */
+	long budget;
+
+	/* Sequences which give the same cube as a shorter or an already visited sequence. */
+	static bool redundant(const std::string &path, char command) {
+		int length = path.length();
+
+		/* Four turns of a side give the same cube. */
+		if(length >= 3 && path[length-1] == command && path[length-2] == command && path[length-3] == command) {
+			return( true );
+		}
+
+		/* Independent moves are tried in a single order. */
+		if(length >= 1 && command < path[length-1] && RubiksCubeMoves<N>::instance().commute(command, path[length-1]) == true) {
+			return( true );
+		}
+
+		return( false );
+	}
+
+	void search(Context &context, const RubiksCubeTracker<N> &tracker, int remaining, double step) const {
+		const std::string &alphabet = RubiksCube<N>::alphabet();
+
+		for(int m=0; m<alphabet.length(); m++) {
+			if(context.nodes >= budget) {
+				return;
+			}
+			if(redundant(context.path, alphabet[m]) == true) {
+				continue;
+			}
+
+			RubiksCubeTracker<N> child = tracker;
+			child.move(alphabet[m]);
+			context.nodes++;
+			context.path.push_back(alphabet[m]);
+
+			double value = child.measure();
+			if(value < context.best) {
+				context.best = value;
+				context.suffix = context.path;
+			}
+
+			if(remaining > 1 && value-(remaining-1)*step < context.best) {
+				search(context, child, remaining-1, step);
+			}
+
+			context.path.pop_back();
+		}
+	}
+
+public:
+	MemeticSearch(int depth=MEMETIC_DEPTH, long budget=MEMETIC_BUDGET) {
+		this->depth = depth;
+		this->budget = budget;
+	}
+
+	/* Moves which bring the cube closer to the reference. False if none are found within the depth and the budget. */
+	bool improve(const RubiksCubeTracker<N> &start, std::string &suffix, double &distance) const {
+		Context context;
+		context.nodes = 0;
+		context.best = start.measure();
+
+		const double initial = context.best;
+		for(int d=1; d<=depth && context.nodes<budget; d++) {
+			search(context, start, d, start.bound());
+		}
+
+		if(context.best >= initial) {
+			return( false );
+		}
+
+		suffix = context.suffix;
+		distance = start.distance(context.best);
+		return( true );
+	}
+};
+
+#endif
@@ -0,0 +1,248 @@
+#ifndef NODEMIGRATION_H_INCLUDED
+#define NODEMIGRATION_H_INCLUDED
+
+#include "Chromosome.h"
+
+/*
+ * Migration which follows the placement of the processes. The islands of a
+ * group on the same node form a ring and each of them takes the best
+ * chromosome of the next one from a shared memory window, often and without
+ * any message. Only the first island of each node sends its best chromosome
+ * to the first island of the next node, less often, and from there it
+ * spreads inside the node by the ring.
+ *
+ * Both windows are made once over all ranks, since windows made at the same
+ * time by several groups of processes are not reliable with some MPI
+ * libraries, and each group uses only the slots of its own ranks. A slot
+ * which is read while it is written does not match its hash and is skipped.
+ */
+class NodeMigration {
+private:
+	struct Slot {
+		unsigned long long genome;
+		int length;
+		char command[MIGRANT_LENGTH];
+	};
+
+	/* Ranks on the same node. */
+	MPI_Comm node;
+
+	MPI_Comm comm;
+
+	/* Slot of the best chromosome of each rank on the node. */
+	MPI_Win shared;
+
+	/* Slot of each rank for the migrants from the other nodes. */
+	MPI_Win inboxes;
+
+	Slot *own;
+
+	/* Slot of the next island on the same node, NULL when it is alone. */
+	Slot *next;
+
+	/* Rank in the world of the first island of the next node, -1 when this is not the first island of its node. */
+	int leader;
+
+	/* Rank in the world. */
+	int self;
+
+	bool opened;
+
+	static void write(Slot &slot, const Chromosome &chromosome) {
+		slot.length = 0;
+		slot.genome = chromosome.genome;
+		memcpy(slot.command, chromosome.command.data(), chromosome.command.length());
+		slot.length = chromosome.command.length();
+	}
+
+	static bool read(const Slot &slot, Chromosome &chromosome) {
+		Slot copy;
+		memcpy(&copy, &slot, sizeof(Slot));
+		if(copy.length <= 0 || copy.length > MIGRANT_LENGTH) {
+			return( false );
+		}
+
+		chromosome = Chromosome(std::string(copy.command, copy.length), INVALID_FITNESS_VALUE);
+		return( chromosome.genome == copy.genome );
+	}
+
+public:
+	NodeMigration() {
+		node = MPI_COMM_NULL;
+		comm = MPI_COMM_NULL;
+		shared = MPI_WIN_NULL;
+		inboxes = MPI_WIN_NULL;
+		own = NULL;
+		next = NULL;
+		leader = -1;
+		self = 0;
+		opened = false;
+	}
+
+	/* Collective over all ranks which can take part in any group. */
+	void create(MPI_Comm world) {
+		char *memory = NULL;
+
+		MPI_Comm_rank(world, &self);
+		MPI_Comm_split_type(world, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, &node);
+		MPI_Win_allocate_shared(sizeof(Slot), 1, MPI_INFO_NULL, node, &own, &shared);
+		MPI_Win_lock_all(0, shared);
+		MPI_Win_allocate(sizeof(Slot), 1, MPI_INFO_NULL, world, &memory, &inboxes);
+		MPI_Win_lock_all(0, inboxes);
+
+		memset(own, 0, sizeof(Slot));
+		memset(memory, 0, sizeof(Slot));
+		MPI_Win_sync(shared);
+		MPI_Win_sync(inboxes);
+		MPI_Barrier(world);
+	}
+
+	/* Collective over all ranks which can take part in any group. */
+	void free() {
+		if(shared == MPI_WIN_NULL) {
+			return;
+		}
+
+		MPI_Win_unlock_all(inboxes);
+		MPI_Win_free(&inboxes);
+		MPI_Win_unlock_all(shared);
+		MPI_Win_free(&shared);
+		MPI_Comm_free(&node);
+	}
+
+	bool isOpen() const {
+		return( opened );
+	}
+
+	/* Collective over the group. The root of the group has no island. */
+	void open(MPI_Comm comm, int root) {
+		if(shared == MPI_WIN_NULL) {
+			return;
+		}
+
+		MPI_Group group;
+		MPI_Group local;
+		MPI_Group all;
+		MPI_Comm_group(comm, &group);
+		MPI_Comm_group(node, &local);
+		MPI_Win_get_group(inboxes, &all);
+
+		/* Islands of the group on this node, in the order of the node ranks. */
+		int rank = 0;
+		int count = 0;
+		MPI_Comm_rank(node, &rank);
+		MPI_Comm_size(node, &count);
+		std::vector<int> ranks(count);
+		std::vector<int> translated(count);
+		for(int i=0; i<count; i++) {
+			ranks[i] = i;
+		}
+		MPI_Group_translate_ranks(local, count, &ranks[0], group, &translated[0]);
+
+		std::vector<int> islands;
+		int position = -1;
+		for(int i=0; i<count; i++) {
+			if(translated[i] == MPI_UNDEFINED || translated[i] == root) {
+				continue;
+			}
+			if(i == rank) {
+				position = islands.size();
+			}
+			islands.push_back(i);
+		}
+
+		next = NULL;
+		if(position >= 0 && islands.size() > 1) {
+			MPI_Aint size = 0;
+			int unit = 0;
+			MPI_Win_shared_query(shared, islands[(position+1)%islands.size()], &size, &unit, &next);
+		}
+
+		/* Each island tells the first island of its node, so the first islands of all nodes are known. */
+		int first = -1;
+		if(position >= 0) {
+			MPI_Group_translate_ranks(local, 1, &islands[0], all, &first);
+		}
+		int members = 0;
+		MPI_Comm_size(comm, &members);
+		std::vector<int> firsts(members);
+		MPI_Allgather(&first, 1, MPI_INT, &firsts[0], 1, MPI_INT, comm);
+		std::sort(firsts.begin(), firsts.end());
+		firsts.erase(std::unique(firsts.begin(), firsts.end()), firsts.end());
+		firsts.erase(std::remove(firsts.begin(), firsts.end(), -1), firsts.end());
+
+		leader = -1;
+		if(position == 0 && firsts.size() > 1) {
+			int index = std::find(firsts.begin(), firsts.end(), first) - firsts.begin();
+			leader = firsts[(index+1)%firsts.size()];
+		}
+
+		MPI_Group_free(&group);
+		MPI_Group_free(&local);
+		MPI_Group_free(&all);
+
+		/* Migrants of the previous group are not taken. */
+		own->length = 0;
+		MPI_Win_sync(shared);
+		Slot empty;
+		memset(&empty, 0, sizeof(Slot));
+		MPI_Put(&empty, sizeof(Slot), MPI_BYTE, self, 0, sizeof(Slot), MPI_BYTE, inboxes);
+		MPI_Win_flush(self, inboxes);
+
+		this->comm = comm;
+		MPI_Barrier(comm);
+		opened = true;
+	}
+
+	/* Collective over the group, so no access is left when the migration is opened again. */
+	void close() {
+		if(opened == false) {
+			return;
+		}
+
+		MPI_Barrier(comm);
+		next = NULL;
+		leader = -1;
+		opened = false;
+	}
+
+	/* The best chromosome of the island is offered and the migrants for it are taken, also from the other nodes when it is far. */
+	void exchange(const Chromosome &best, bool far, std::vector<Chromosome> &migrants) {
+		migrants.clear();
+		if(opened == false) {
+			return;
+		}
+
+		/* A best which does not fit in a slot is not given, but the migrants are still taken. */
+		const bool fits = (best.command.length() <= MIGRANT_LENGTH);
+
+		if(fits == true) {
+			write(*own, best);
+		}
+		MPI_Win_sync(shared);
+
+		Chromosome migrant;
+		if(next != NULL && read(*next, migrant) == true) {
+			migrants.push_back(migrant);
+		}
+
+		if(far == false || leader == -1) {
+			return;
+		}
+
+		Slot slot;
+		if(fits == true) {
+			write(slot, best);
+			MPI_Put(&slot, sizeof(Slot), MPI_BYTE, leader, 0, sizeof(Slot), MPI_BYTE, inboxes);
+			MPI_Win_flush(leader, inboxes);
+		}
+
+		MPI_Get(&slot, sizeof(Slot), MPI_BYTE, self, 0, sizeof(Slot), MPI_BYTE, inboxes);
+		MPI_Win_flush(self, inboxes);
+		if(read(slot, migrant) == true) {
+			migrants.push_back(migrant);
+		}
+	}
+};
+
+#endif
@@ -0,0 +1,199 @@
+#ifndef PEEPHOLECOMPRESSION_H_INCLUDED
+#define PEEPHOLECOMPRESSION_H_INCLUDED
+
+#include "RubiksCube.h"
+#include "RubiksCubeMoves.h"
+#include "TaskPool.h"
+
+/*
+ * Shorter solution with the same cube at the end. A window slides over the
+ * moves and each segment in it is replaced with the shortest sequence which
+ * moves the facelets in the same way, when such a sequence is in a table of
+ * all sequences up to a few turns. Segments which give back the same cube
+ * are removed, since the empty sequence is in the table too.
+ *
+ * The table is keyed by a hash of the permutation of the facelets, and each
+ * replacement is checked against the permutation of the segment, so a
+ * collision of the hashes never changes the cube. Passes are repeated while
+ * the solution gets shorter.
+ */
+template<int N>
+class PeepholeCompression {
+private:
+	static const int FACELETS = RubiksCubeMoves<N>::FACELETS;
+
+	typedef typename RubiksCubeMoves<N>::Index Index;
+
+	/* Sequences in the table should fit in the memory, also for the big cubes with many turns. */
+	static const long long MAXIMUM_COUNT = 1LL << 20;
+
+	/* Shortest sequence of turns for each permutation of the facelets up to the depth of the table. */
+	std::unordered_map<unsigned long long, std::string> sequences;
+
+	static void identity(Index labels[]) {
+		for(int f=0; f<FACELETS; f++) {
+			labels[f] = f;
+		}
+	}
+
+	static unsigned long long hash(const Index labels[]) {
+		unsigned long long result = 14695981039346656037ULL;
+		for(int f=0; f<FACELETS; f++) {
+			result = (result ^ labels[f]) * 1099511628211ULL;
+		}
+		return( result );
+	}
+
+	/* Breadth first, so the first sequence found for a permutation is one of the shortest. The search stops at the depth or when the table is full. */
+	PeepholeCompression() {
+		const RubiksCubeMoves<N> &moves = RubiksCubeMoves<N>::instance();
+		const std::string &alphabet = RubiksCube<N>::alphabet();
+
+		std::vector< std::vector<Index> > level(1, std::vector<Index>(FACELETS));
+		std::vector<std::string> commands(1, "");
+		identity(&level[0][0]);
+		sequences[hash(&level[0][0])] = "";
+
+		for(int depth=0; depth<PEEPHOLE_TABLE_DEPTH && level.size()>0; depth++) {
+			std::vector< std::vector<Index> > next;
+			std::vector<std::string> extended;
+
+			/* Permutations of the deepest level are not continued, so they are not kept. */
+			const bool last = (depth == PEEPHOLE_TABLE_DEPTH-1);
+
+			for(int s=0; s<level.size() && sequences.size()<MAXIMUM_COUNT; s++) {
+				for(int m=0; m<alphabet.length() && sequences.size()<MAXIMUM_COUNT; m++) {
+					std::vector<Index> labels = level[s];
+					RubiksCubeMoves<N>::apply(*moves.find(alphabet[m]), &labels[0]);
+
+					unsigned long long key = hash(&labels[0]);
+					if(sequences.count(key) > 0) {
+						continue;
+					}
+
+					sequences[key] = commands[s] + alphabet[m];
+					if(last == false) {
+						next.push_back(labels);
+						extended.push_back(commands[s] + alphabet[m]);
+					}
+				}
+			}
+
+			level.swap(next);
+			commands.swap(extended);
+		}
+	}
+
+	/* Shortest sequence with the given permutation, false when it is not in the table or it is not shorter. */
+	bool find(const Index labels[], int length, std::string &result) const {
+		typename std::unordered_map<unsigned long long, std::string>::const_iterator found = sequences.find(hash(labels));
+		if(found == sequences.end() || found->second.length() >= length) {
+			return( false );
+		}
+
+		const RubiksCubeMoves<N> &moves = RubiksCubeMoves<N>::instance();
+		Index check[FACELETS];
+		identity(check);
+		for(int i=0; i<found->second.length(); i++) {
+			RubiksCubeMoves<N>::apply(*moves.find(found->second[i]), check);
+		}
+		if(memcmp(check, labels, sizeof(check)) != 0) {
+			return( false );
+		}
+
+		result = found->second;
+		return( true );
+	}
+
+	/* One pass of the window, the longest saving at each position first. */
+	std::string shorten(const std::string &commands) const {
+		const RubiksCubeMoves<N> &moves = RubiksCubeMoves<N>::instance();
+
+		std::string result = "";
+		for(int i=0; i<commands.length();) {
+			Index labels[FACELETS];
+			identity(labels);
+
+			int saving = 0;
+			int length = 0;
+			std::string best;
+			std::string replacement;
+			for(int l=1; l<=PEEPHOLE_WINDOW && i+l<=commands.length(); l++) {
+				RubiksCubeMoves<N>::apply(*moves.find(commands[i+l-1]), labels);
+				if(find(labels, l, replacement) == true && l-(int)replacement.length() > saving) {
+					saving = l - replacement.length();
+					length = l;
+					best = replacement;
+				}
+			}
+
+			if(saving > 0) {
+				result += best;
+				i += length;
+			} else {
+				result += commands[i];
+				i++;
+			}
+		}
+
+		return( result );
+	}
+
+	/* Only the commands which move the cube. */
+	static std::string strip(const std::string &commands) {
+		const RubiksCubeMoves<N> &moves = RubiksCubeMoves<N>::instance();
+
+		std::string result = "";
+		for(int i=0; i<commands.length(); i++) {
+			if(moves.find(commands[i]) != NULL) {
+				result += commands[i];
+			}
+		}
+
+		return( result );
+	}
+
+public:
+	static const PeepholeCompression<N>& instance() {
+		static PeepholeCompression<N> compression;
+		return( compression );
+	}
+
+	/* Parts of a long solution are shortened by the threads of the pool, and the seams between them by the last passes. */
+	std::string compress(const std::string &commands, TaskPool *pool=NULL) const {
+		std::string result = strip(commands);
+		if(PEEPHOLE_TABLE_DEPTH <= 0) {
+			return( result );
+		}
+
+		if(pool != NULL && pool->size() > 1 && result.length() > 2*pool->size()*PEEPHOLE_WINDOW) {
+			std::vector<std::string> parts(pool->size());
+			for(int p=0; p<parts.size(); p++) {
+				parts[p] = result.substr(p*result.length()/parts.size(), (p+1)*result.length()/parts.size() - p*result.length()/parts.size());
+				pool->submit([this, &parts, p]() {
+					std::string part;
+					do {
+						part = parts[p];
+						parts[p] = shorten(part);
+					} while(parts[p].length() < part.length());
+				});
+			}
+			pool->wait();
+
+			result = "";
+			for(int p=0; p<parts.size(); p++) {
+				result += parts[p];
+			}
+		}
+
+		std::string previous;
+		do {
+			previous = result;
+			result = shorten(previous);
+		} while(result.length() < previous.length());
+
+		return( result );
+	}
+};
+
+#endif
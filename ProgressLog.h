@@ -0,0 +1,156 @@
+#ifndef PROGRESSLOG_H_INCLUDED
+#define PROGRESSLOG_H_INCLUDED
+
+/*
+ * History of the rounds as JSON lines, one object for each record, which can
+ * be followed with tail or read line by line by other programs. The thread
+ * which makes the records only puts them in a ring and a background thread
+ * formats and writes them, so the root never waits for the file.
+ *
+ * The ring has a single writer and a single reader and no locks: the writer
+ * moves the head after the record is stored and the reader moves the tail
+ * after the record is written. When the ring is full the new record is
+ * dropped and counted, instead of waiting.
+ */
+class ProgressLog {
+public:
+	struct Record {
+		/* Static text, as "worker" or "global". */
+		const char *kind;
+
+		/* Seconds since the start of the log. */
+		double time;
+
+		int phase;
+		long round;
+		int rank;
+		double fitness;
+		int length;
+		double evaluations;
+	};
+
+private:
+	std::vector<Record> records;
+
+	/* Number of the next record to be stored, which only grows. */
+	std::atomic<unsigned long> head;
+
+	/* Number of the next record to be written, which only grows. */
+	std::atomic<unsigned long> tail;
+
+	std::atomic<long> dropped;
+
+	std::atomic<bool> running;
+
+	std::thread writer;
+
+	std::ofstream out;
+
+	std::chrono::steady_clock::time_point since;
+
+	ProgressLog() : records(PROGRESS_LOG_CAPACITY>1 ? PROGRESS_LOG_CAPACITY : 1) {
+		head.store(0);
+		tail.store(0);
+		dropped.store(0);
+		running.store(false);
+	}
+
+	/* Records stored so far are written and flushed, false when there was none. */
+	bool drain() {
+		unsigned long last = head.load(std::memory_order_acquire);
+		unsigned long next = tail.load(std::memory_order_relaxed);
+		if(next == last) {
+			return( false );
+		}
+
+		for(; next<last; next++) {
+			const Record &record = records[next%records.size()];
+			out << "{\"kind\":\"" << record.kind << "\",\"time\":" << record.time << ",\"phase\":" << record.phase << ",\"round\":" << record.round << ",\"rank\":" << record.rank;
+			out << ",\"fitness\":" << record.fitness << ",\"length\":" << record.length << ",\"evaluations\":" << record.evaluations << "}\n";
+			tail.store(next+1, std::memory_order_release);
+		}
+		out.flush();
+
+		return( true );
+	}
+
+	void loop() {
+		while(running.load() == true) {
+			if(drain() == false) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(10));
+			}
+		}
+		drain();
+	}
+
+public:
+	static ProgressLog& instance() {
+		static ProgressLog log;
+		return( log );
+	}
+
+	~ProgressLog() {
+		stop();
+	}
+
+	/* The file is continued when a run is resumed. */
+	bool start(const std::string &name, bool append) {
+		if(running.load() == true || name == "") {
+			return( false );
+		}
+
+		out.open(name.c_str(), append ? std::ios::app : std::ios::trunc);
+		if(!out) {
+			return( false );
+		}
+
+		out.precision(10);
+		since = std::chrono::steady_clock::now();
+		running.store(true);
+		writer = std::thread([this]() {
+			loop();
+		});
+
+		return( true );
+	}
+
+	/* Waits until all stored records are written. */
+	void stop() {
+		if(running.load() == false) {
+			return;
+		}
+
+		running.store(false);
+		writer.join();
+		if(dropped.load() > 0) {
+			out << "{\"kind\":\"dropped\",\"count\":" << dropped.load() << "}\n";
+		}
+		out.close();
+	}
+
+	/* Should be called by a single thread, and does nothing when the log is not started. */
+	void log(const char kind[], int phase, long round, int rank, double fitness, int length, double evaluations) {
+		if(running.load(std::memory_order_relaxed) == false) {
+			return;
+		}
+
+		unsigned long next = head.load(std::memory_order_relaxed);
+		if(next - tail.load(std::memory_order_acquire) >= records.size()) {
+			dropped++;
+			return;
+		}
+
+		Record &record = records[next%records.size()];
+		record.kind = kind;
+		record.time = std::chrono::duration<double>(std::chrono::steady_clock::now()-since).count();
+		record.phase = phase;
+		record.round = round;
+		record.rank = rank;
+		record.fitness = fitness;
+		record.length = length;
+		record.evaluations = evaluations;
+		head.store(next+1, std::memory_order_release);
+	}
+};
+
+#endif
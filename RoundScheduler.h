@@ -0,0 +1,67 @@
+#ifndef ROUNDSCHEDULER_H_INCLUDED
+#define ROUNDSCHEDULER_H_INCLUDED
+
+#include "Configuration.h"
+
+class RoundScheduler {
+private:
+	/* Smoothing factor for the measured speed of the workers. */
+	static constexpr double RATE_SMOOTHING = 0.5;
+
+	/* Measured epoches per second for each rank. */
+	std::map<int,double> rates;
+
+	long epoches;
+
+	double budget;
+
+public:
+	RoundScheduler(long epoches=Configuration::instance().epoches, double budget=ROUND_TIME_BUDGET) {
+		this->epoches = epoches;
+		this->budget = budget;
+	}
+
+	double getBudget() const {
+		return( budget );
+	}
+
+	/* Number of epoches which the rank should do in the next round. */
+	long getEpoches(int rank) const {
+		if(ADAPTIVE_EPOCHES == false || rates.count(rank) == 0) {
+			return( epoches );
+		}
+
+		/* With time budget all ranks should be busy until the end of the round. */
+		if(budget > 0) {
+			long result = (long)(rates.at(rank) * budget);
+			return( result<1 ? 1 : result );
+		}
+
+		/* Without time budget keep the total amount of work, but give more of it to the faster ranks. */
+		double total = 0;
+		for(std::map<int,double>::const_iterator i=rates.begin(); i!=rates.end(); i++) {
+			total += i->second;
+		}
+		if(total <= 0) {
+			return( epoches );
+		}
+
+		long result = (long)(epoches * rates.size() * rates.at(rank) / total);
+		return( result<1 ? 1 : result );
+	}
+
+	void report(int rank, long epoches, double seconds) {
+		if(epoches <= 0 || seconds <= 0) {
+			return;
+		}
+
+		double rate = epoches / seconds;
+		if(rates.count(rank) == 0) {
+			rates[rank] = rate;
+		} else {
+			rates[rank] = RATE_SMOOTHING*rate + (1-RATE_SMOOTHING)*rates[rank];
+		}
+	}
+};
+
+#endif
@@ -6,206 +6,231 @@
 #include "RubiksColor.h"
 #include "DistanceType.h"
 #include "RotationDirection.h"
-
+#include "RubiksCubeState.h"
+
+/*
+ * Cube with N layers on each side. Besides the turns of the sides, the inner
+ * layers can be turned as slice moves, but not the middle layer of odd cubes,
+ * so the centers stay in place.
+ */
+template<int N>
 class RubiksCube {
+	static_assert(N >= 2 && N <= 7, "Cube should have from 2 to 7 layers.");
+
 private:
-	int top[3][3];
-	int left[3][3];
-	int right[3][3];
-	int front[3][3];
-	int back[3][3];
-	int down[3][3];
+	RubiksCubeState<N> state;
 
-	int (*sides[6])[3][3];
+	DistanceType distance = EUCLIDEAN;
 
-	std::string result;
+	/* Order of the sides in the commands. */
+	static constexpr char SIDES[] = {TOP, LEFT, RIGHT, FRONT, BACK, DOWN, '\0'};
 
-	DistanceType distance = EUCLIDEAN;
+	static std::string genes() {
+		std::string result = "";
+		for(int d=0; d<N/2; d++) {
+			for(int s=0; SIDES[s]!='\0'; s++) {
+				result += command((RubiksSide)SIDES[s], d);
+			}
+		}
+
+		return( result );
+	}
+
+	/* Turn of the layer at the given depth from the side, without the side itself. */
+	void spinSide(RubiksSide side, int depth) {
+		unsigned char (*top)[N] = state.sides[RubiksCubeState<N>::TOP_SIDE];
+		unsigned char (*left)[N] = state.sides[RubiksCubeState<N>::LEFT_SIDE];
+		unsigned char (*right)[N] = state.sides[RubiksCubeState<N>::RIGHT_SIDE];
+		unsigned char (*front)[N] = state.sides[RubiksCubeState<N>::FRONT_SIDE];
+		unsigned char (*back)[N] = state.sides[RubiksCubeState<N>::BACK_SIDE];
+		unsigned char (*down)[N] = state.sides[RubiksCubeState<N>::DOWN_SIDE];
 
-	void spinSide(RubiksSide side) {
-		static int buffer[ 3 ];
+		/* Near and far rows or columns of the neighbour sides. */
+		const int near = depth;
+		const int far = N - depth - 1;
+
+		unsigned char buffer[ N ];
 
 		if (side == TOP) {
-			for (int i = 0; i < 3; i++) {
-				buffer[i] = left[i][2];
+			for (int i = 0; i < N; i++) {
+				buffer[i] = left[i][far];
 			}
-			for (int i = 0; i < 3; i++) {
-				left[i][2] = front[0][i];
+			for (int i = 0; i < N; i++) {
+				left[i][far] = front[near][i];
 			}
-			for (int i = 0; i < 3; i++) {
-				front[0][i] = right[3 - i - 1][0];
+			for (int i = 0; i < N; i++) {
+				front[near][i] = right[N - i - 1][near];
 			}
-			for (int i = 0; i < 3; i++) {
-				right[i][0] = back[2][i];
+			for (int i = 0; i < N; i++) {
+				right[i][near] = back[far][i];
 			}
-			for (int i = 0; i < 3; i++) {
-				back[2][3 - i - 1] = buffer[i];
+			for (int i = 0; i < N; i++) {
+				back[far][N - i - 1] = buffer[i];
 			}
 		} else if (side == LEFT) {
-			for (int i = 0; i < 3; i++) {
-				buffer[i] = down[i][2];
+			for (int i = 0; i < N; i++) {
+				buffer[i] = down[i][far];
 			}
-			for (int i = 0; i < 3; i++) {
-				down[3 - i - 1][2] = front[i][0];
+			for (int i = 0; i < N; i++) {
+				down[N - i - 1][far] = front[i][near];
 			}
-			for (int i = 0; i < 3; i++) {
-				front[i][0] = top[i][0];
+			for (int i = 0; i < N; i++) {
+				front[i][near] = top[i][near];
 			}
-			for (int i = 0; i < 3; i++) {
-				top[i][0] = back[i][0];
+			for (int i = 0; i < N; i++) {
+				top[i][near] = back[i][near];
 			}
-			for (int i = 0; i < 3; i++) {
-				back[3 - i - 1][0] = buffer[i];
+			for (int i = 0; i < N; i++) {
+				back[N - i - 1][near] = buffer[i];
 			}
 		} else if (side == BACK) {
-			for (int i = 0; i < 3; i++) {
-				buffer[i] = down[0][i];
+			for (int i = 0; i < N; i++) {
+				buffer[i] = down[near][i];
 			}
-			for (int i = 0; i < 3; i++) {
-				down[0][i] = left[0][i];
+			for (int i = 0; i < N; i++) {
+				down[near][i] = left[near][i];
 			}
-			for (int i = 0; i < 3; i++) {
-				left[0][i] = top[0][i];
+			for (int i = 0; i < N; i++) {
+				left[near][i] = top[near][i];
 			}
-			for (int i = 0; i < 3; i++) {
-				top[0][i] = right[0][i];
+			for (int i = 0; i < N; i++) {
+				top[near][i] = right[near][i];
 			}
-			for (int i = 0; i < 3; i++) {
-				right[0][i] = buffer[i];
+			for (int i = 0; i < N; i++) {
+				right[near][i] = buffer[i];
 			}
 		} else if (side == RIGHT) {
-			for (int i = 0; i < 3; i++) {
-				buffer[i] = down[i][0];
+			for (int i = 0; i < N; i++) {
+				buffer[i] = down[i][near];
 			}
-			for (int i = 0; i < 3; i++) {
-				down[i][0] = back[3 - i - 1][2];
+			for (int i = 0; i < N; i++) {
+				down[i][near] = back[N - i - 1][far];
 			}
-			for (int i = 0; i < 3; i++) {
-				back[i][2] = top[i][2];
+			for (int i = 0; i < N; i++) {
+				back[i][far] = top[i][far];
 			}
-			for (int i = 0; i < 3; i++) {
-				top[i][2] = front[i][2];
+			for (int i = 0; i < N; i++) {
+				top[i][far] = front[i][far];
 			}
-			for (int i = 0; i < 3; i++) {
-				front[3 - i - 1][2] = buffer[i];
+			for (int i = 0; i < N; i++) {
+				front[N - i - 1][far] = buffer[i];
 			}
 		} else if (side == FRONT) {
-			for (int i = 0; i < 3; i++) {
-				buffer[i] = down[2][i];
+			for (int i = 0; i < N; i++) {
+				buffer[i] = down[far][i];
 			}
-			for (int i = 0; i < 3; i++) {
-				down[2][i] = right[2][i];
+			for (int i = 0; i < N; i++) {
+				down[far][i] = right[far][i];
 			}
-			for (int i = 0; i < 3; i++) {
-				right[2][i] = top[2][i];
+			for (int i = 0; i < N; i++) {
+				right[far][i] = top[far][i];
 			}
-			for (int i = 0; i < 3; i++) {
-				top[2][i] = left[2][i];
+			for (int i = 0; i < N; i++) {
+				top[far][i] = left[far][i];
 			}
-			for (int i = 0; i < 3; i++)
-				left[2][i] = buffer[i];
+			for (int i = 0; i < N; i++)
+				left[far][i] = buffer[i];
 		} else if (side == DOWN) {
-			for (int i = 0; i < 3; i++) {
-				buffer[i] = front[2][i];
+			for (int i = 0; i < N; i++) {
+				buffer[i] = front[far][i];
 			}
-			for (int i = 0; i < 3; i++) {
-				front[2][i] = left[i][0];
+			for (int i = 0; i < N; i++) {
+				front[far][i] = left[i][near];
 			}
-			for (int i = 0; i < 3; i++) {
-				left[i][0] = back[0][3 - i - 1];
+			for (int i = 0; i < N; i++) {
+				left[i][near] = back[near][N - i - 1];
 			}
-			for (int i = 0; i < 3; i++) {
-				back[0][i] = right[i][2];
+			for (int i = 0; i < N; i++) {
+				back[near][i] = right[i][far];
 			}
-			for (int i = 0; i < 3; i++) {
-				right[3 - i - 1][2] = buffer[i];
+			for (int i = 0; i < N; i++) {
+				right[N - i - 1][far] = buffer[i];
 			}
 		}
 	}
 
-	void spinClockwise(int side[3][3], int times, RubiksSide index) {
-		static int buffer[3][3];
-		static int newarray[3][3];
+	void spinClockwise(unsigned char side[N][N], int times, RubiksSide index, int depth) {
+		unsigned char buffer[N][N];
+		unsigned char newarray[N][N];
 
 		if (times == 0) {
 			return;
 		}
 
+		/* Inner layers do not turn any side. */
+		if (depth > 0) {
+			for (int t = 0; t < times; t++) {
+				spinSide(index, depth);
+			}
+			return;
+		}
+
 		/* Transponse. */
-		for (int j = 0; j < 3; j++) {
-			for (int i = 0; i < 3; i++) {
+		for (int j = 0; j < N; j++) {
+			for (int i = 0; i < N; i++) {
 				newarray[j][i] = side[i][j];
 			}
 		}
 		/* Rearrange. */
-		for (int i = 0; i < 3; i++) {
-			static int cache = 0;
-			cache = newarray[i][0];
-			newarray[i][0] = newarray[i][2];
-			newarray[i][2] = cache;
+		for (int i = 0; i < N; i++) {
+			for (int j = 0; j < N/2; j++) {
+				unsigned char cache = 0;
+				cache = newarray[i][j];
+				newarray[i][j] = newarray[i][N - j - 1];
+				newarray[i][N - j - 1] = cache;
+			}
 		}
 
-		spinSide(index);
-		memcpy(buffer, newarray, sizeof(int)*3*3);
+		spinSide(index, depth);
+		memcpy(buffer, newarray, sizeof(buffer));
 
 		for (int t = 1; t < times; t++) {
-			for (int j = 0; j < 3; j++) {
-				for (int i = 0; i < 3; i++) {
+			for (int j = 0; j < N; j++) {
+				for (int i = 0; i < N; i++) {
 					newarray[j][i] = buffer[i][j];
 				}
 			}
-			for (int i = 0; i < 3; i++) {
-				static int cache = 0;
-				cache = newarray[i][0];
-				newarray[i][0] = newarray[i][2];
-				newarray[i][2] = cache;
+			for (int i = 0; i < N; i++) {
+				for (int j = 0; j < N/2; j++) {
+					unsigned char cache = 0;
+					cache = newarray[i][j];
+					newarray[i][j] = newarray[i][N - j - 1];
+					newarray[i][N - j - 1] = cache;
+				}
 			}
 
-			spinSide(index);
+			spinSide(index, depth);
 
-			memcpy(buffer, newarray, sizeof(int)*3*3);
+			memcpy(buffer, newarray, sizeof(buffer));
 		}
 
-		memcpy(side, buffer, sizeof(int)*3*3);
+		memcpy(side, buffer, sizeof(buffer));
 	}
 
-	double euclidean(const RubiksCube &cube) const {
+	double euclidean(const RubiksCube<N> &cube) const {
 		double distance = 0.0;
 
-		for(int i=0; i<3; i++) {
-			for(int j=0; j<3; j++) {
-				distance += (top[i][j]-cube.top[i][j])*(top[i][j]-cube.top[i][j]);
-				distance += (left[i][j]-cube.left[i][j])*(left[i][j]-cube.left[i][j]);
-				distance += (right[i][j]-cube.right[i][j])*(right[i][j]-cube.right[i][j]);
-				distance += (front[i][j]-cube.front[i][j])*(front[i][j]-cube.front[i][j]);
-				distance += (back[i][j]-cube.back[i][j])*(back[i][j]-cube.back[i][j]);
-				distance += (down[i][j]-cube.down[i][j])*(down[i][j]-cube.down[i][j]);
+		for(int s=0; s<6; s++) {
+			for(int i=0; i<N; i++) {
+				for(int j=0; j<N; j++) {
+					int difference = state.sides[s][i][j] - cube.state.sides[s][i][j];
+					distance += difference*difference;
+				}
 			}
 		}
 
 		return sqrt(distance);
 	}
 
-	double colors(const RubiksCube &cube) const {
-		//TODO Change array with STL maps.
-		static const double coefficients[7][7] = {
-			{0, 0, 0, 0, 0, 0, 0},
-			{0, 1, 2, 2, 2, 2, 4},
-			{0, 2, 1, 2, 4, 2, 2},
-			{0, 2, 2, 1, 2, 4, 2},
-			{0, 2, 4, 2, 1, 2, 2},
-			{0, 2, 2, 4, 2, 1, 2},
-			{0, 4, 2, 2, 2, 2, 1},
-		};
-
+	double colors(const RubiksCube<N> &cube) const {
 		double distance = 0.0;
 
 		/* Count matches for all sides. */
 		for(int s=0; s<6; s++) {
-			for(int i=0; i<3; i++) {
-				for(int j=0; j<3; j++) {
+			for(int i=0; i<N; i++) {
+				for(int j=0; j<N; j++) {
 					/* If colors are equal calculate distance. */
-					distance += coefficients[(*sides[s])[1][1]][(*sides[s])[i][j]];
+					distance += coefficient(state.sides[s][N/2][N/2], cube.state.sides[s][i][j]);
 				}
 			}
 		}
@@ -213,11 +238,11 @@ private:
 		return distance;
 	}
 
-	double euclidean(const int side1[3][3], const int side2[3][3]) const {
+	double euclidean(const unsigned char side1[N][N], const unsigned char side2[N][N]) const {
 		double distance = 0.0;
 
-		for(int i=0; i<3; i++) {
-			for(int j=0; j<3; j++) {
+		for(int i=0; i<N; i++) {
+			for(int j=0; j<N; j++) {
 				distance += (side1[i][j]-side2[i][j])*(side1[i][j]-side2[i][j]);
 			}
 		}
@@ -225,7 +250,7 @@ private:
 		return sqrt(distance);
 	}
 
-	double hausdorff(const RubiksCube &cube) const {
+	double hausdorff(const RubiksCube<N> &cube) const {
 		/* Minimums should be found for each side. */
 		double min[] = {INT_MAX, INT_MAX, INT_MAX, INT_MAX, INT_MAX, INT_MAX};
 
@@ -233,7 +258,7 @@ private:
 		for(int s1=0; s1<6; s1++) {
 			for(int s2=0; s2<6; s2++) {
 				double distance
-					= euclidean(*sides[s1], *(cube.sides)[s2]);
+					= euclidean(state.sides[s1], cube.state.sides[s2]);
 
 				/* Keep track for the minimum distance. */
 				if(min[s1] > distance) {
@@ -253,38 +278,57 @@ private:
 		return(result);
 	}
 
-	friend std::ostream& operator<< (std::ostream &out, const RubiksCube &cube);
-
 public:
 	RubiksCube() {
 		reset();
-
-		sides[0] = &top;
-		sides[1] = &left;
-		sides[2] = &right;
-		sides[3] = &front;
-		sides[4] = &back;
-		sides[5] = &down;
 	}
 
 	void reset() {
-		for(int i=0; i<3; i++) {
-			for(int j=0; j<3; j++) {
-				top[i][j] = GREEN;
-				left[i][j] = PURPLE;
-				right[i][j] = RED;
-				front[i][j] = WHITE;
-				back[i][j] = YELLOW;
-				down[i][j] = BLUE;
+		for(int i=0; i<N; i++) {
+			for(int j=0; j<N; j++) {
+				state.sides[RubiksCubeState<N>::TOP_SIDE][i][j] = GREEN;
+				state.sides[RubiksCubeState<N>::LEFT_SIDE][i][j] = PURPLE;
+				state.sides[RubiksCubeState<N>::RIGHT_SIDE][i][j] = RED;
+				state.sides[RubiksCubeState<N>::FRONT_SIDE][i][j] = WHITE;
+				state.sides[RubiksCubeState<N>::BACK_SIDE][i][j] = YELLOW;
+				state.sides[RubiksCubeState<N>::DOWN_SIDE][i][j] = BLUE;
 			}
 		}
 	}
 
+	const RubiksCubeState<N>& getState() const {
+		return( state );
+	}
+
+	void setState(const RubiksCubeState<N> &state) {
+		this->state = state;
+	}
+
 	void setDistanceType(DistanceType type) {
 		distance = type;
 	}
 
-	double compare(const RubiksCube &cube) const {
+	DistanceType getDistanceType() const {
+		return( distance );
+	}
+
+	/* Weight of a color on a side with the given center for the weighted distance. */
+	static double coefficient(int center, int color) {
+		//TODO Change array with STL maps.
+		static const double coefficients[7][7] = {
+			{0, 0, 0, 0, 0, 0, 0},
+			{0, 1, 2, 2, 2, 2, 4},
+			{0, 2, 1, 2, 4, 2, 2},
+			{0, 2, 2, 1, 2, 4, 2},
+			{0, 2, 4, 2, 1, 2, 2},
+			{0, 2, 2, 4, 2, 1, 2},
+			{0, 4, 2, 2, 2, 2, 1},
+		};
+
+		return( coefficients[center][color] );
+	}
+
+	double compare(const RubiksCube<N> &cube) const {
 		switch(distance) {
 		case
 				EUCLIDEAN:
@@ -304,7 +348,40 @@ public:
 		}
 	}
 
-	void callSpin(RubiksSide side, RotationDirection direction, int numberOfTimes) {
+	/* Command for the turn of the layer at the given depth from the side: letters of the sides, lower case letters for the next layers and digits for the layers after them. */
+	static char command(RubiksSide side, int depth) {
+		if(depth == 1) {
+			return( tolower(side) );
+		}
+		if(depth == 2) {
+			return( '1' + (strchr(SIDES, side) - SIDES) );
+		}
+
+		return( side );
+	}
+
+	/* False for commands which are not turns of this cube. */
+	static bool decode(char command, RubiksSide &side, int &depth) {
+		for(int d=0; d<N/2; d++) {
+			for(int s=0; SIDES[s]!='\0'; s++) {
+				if(RubiksCube<N>::command((RubiksSide)SIDES[s], d) == command) {
+					side = (RubiksSide)SIDES[s];
+					depth = d;
+					return( true );
+				}
+			}
+		}
+
+		return( false );
+	}
+
+	/* Commands of all turns, which are the genes of the chromosomes. */
+	static const std::string& alphabet() {
+		static const std::string commands = genes();
+		return( commands );
+	}
+
+	void callSpin(RubiksSide side, RotationDirection direction, int numberOfTimes, int depth=0) {
 		if (numberOfTimes < 0) {
 			numberOfTimes = -numberOfTimes;
 			if(direction == CLOCKWISE) {
@@ -321,175 +398,51 @@ public:
 				/* Do nothing. */
 			}
 			if (side == TOP) {
-				spinClockwise(top, numberOfTimes, TOP);
+				spinClockwise(state.sides[RubiksCubeState<N>::TOP_SIDE], numberOfTimes, TOP, depth);
 			}
 			if (side == LEFT) {
-				spinClockwise(left, numberOfTimes, LEFT);
+				spinClockwise(state.sides[RubiksCubeState<N>::LEFT_SIDE], numberOfTimes, LEFT, depth);
 			}
 			if (side == RIGHT) {
-				spinClockwise(right, numberOfTimes, RIGHT);
+				spinClockwise(state.sides[RubiksCubeState<N>::RIGHT_SIDE], numberOfTimes, RIGHT, depth);
 			}
 			if (side == FRONT) {
-				spinClockwise(front, numberOfTimes, FRONT);
+				spinClockwise(state.sides[RubiksCubeState<N>::FRONT_SIDE], numberOfTimes, FRONT, depth);
 			}
 			if (side == BACK) {
-				spinClockwise(back, numberOfTimes, BACK);
+				spinClockwise(state.sides[RubiksCubeState<N>::BACK_SIDE], numberOfTimes, BACK, depth);
 			}
 			if (side == DOWN) {
-				spinClockwise(down, numberOfTimes, DOWN);
+				spinClockwise(state.sides[RubiksCubeState<N>::DOWN_SIDE], numberOfTimes, DOWN, depth);
 			}
 		}
 	}
 
-	void execute(std::string commands) {
+	void execute(const std::string &commands) {
+		RubiksSide side = NONE;
+		int depth = 0;
+
 		for(int i=0; i<commands.length(); i++) {
-			callSpin((RubiksSide)commands[i], CLOCKWISE, 1);
+			if(decode(commands[i], side, depth) == true) {
+				callSpin(side, CLOCKWISE, 1, depth);
+			}
 		}
 	}
 
 	std::string shuffle(int numberOfMoves=0) {
+		const std::string &genes = alphabet();
 		std::string commands = "";
 
 		for(int i=0; i<numberOfMoves; i++) {
-			switch(rand()%6) {
-			case 0:
-				commands+=(char)TOP;
-				break;
-			case 1:
-				commands+=(char)LEFT;
-				break;
-			case 2:
-				commands+=(char)RIGHT;
-				break;
-			case 3:
-				commands+=(char)FRONT;
-				break;
-			case 4:
-				commands+=(char)BACK;
-				break;
-			case 5:
-				commands+=(char)DOWN;
-				break;
-			}
+			commands += genes[rand()%genes.length()];
 		}
 
 		execute(commands);
 
 		return commands;
 	}
-
-	const std::string& toString() {
-		result = "";
-
-		for(int i=0; i<3; i++) {
-			for(int j=0; j<3; j++) {
-				result += std::to_string(top[i][j]) + " ";
-			}
-		}
-		for(int i=0; i<3; i++) {
-			for(int j=0; j<3; j++) {
-				result += std::to_string(left[i][j]) + " ";
-			}
-		}
-		for(int i=0; i<3; i++) {
-			for(int j=0; j<3; j++) {
-				result += std::to_string(right[i][j]) + " ";
-			}
-		}
-		for(int i=0; i<3; i++) {
-			for(int j=0; j<3; j++) {
-				result += std::to_string(front[i][j]) + " ";
-			}
-		}
-		for(int i=0; i<3; i++) {
-			for(int j=0; j<3; j++) {
-				result += std::to_string(back[i][j]) + " ";
-			}
-		}
-		for(int i=0; i<3; i++) {
-			for(int j=0; j<3; j++) {
-				result += std::to_string(down[i][j]) + " ";
-			}
-		}
-
-		/* Trim spaces. */
-		result.erase(result.size()-1, 1);
-		result += '\0';
-
-		return result;
-	}
-
-	void fromString(const char text[]) {
-		std::string buffer(text);
-		std::istringstream in(buffer);
-
-		for(int i=0; i<3; i++) {
-			for(int j=0; j<3; j++) {
-				in >> top[i][j];
-			}
-		}
-		for(int i=0; i<3; i++) {
-			for(int j=0; j<3; j++) {
-				in >> left[i][j];
-			}
-		}
-		for(int i=0; i<3; i++) {
-			for(int j=0; j<3; j++) {
-				in >> right[i][j];
-			}
-		}
-		for(int i=0; i<3; i++) {
-			for(int j=0; j<3; j++) {
-				in >> front[i][j];
-			}
-		}
-		for(int i=0; i<3; i++) {
-			for(int j=0; j<3; j++) {
-				in >> back[i][j];
-			}
-		}
-		for(int i=0; i<3; i++) {
-			for(int j=0; j<3; j++) {
-				in >> down[i][j];
-			}
-		}
-	}
 };
 
-std::ostream& operator<< (std::ostream &out, const RubiksCube &cube) {
-	for(int i=0; i<3; i++) {
-		out << "      ";
-		for(int j=0; j<3; j++) {
-			out << cube.back[i][j] << " ";
-		}
-		out << std::endl;
-	}
-
-	for(int i=0; i<3; i++) {
-		for(int j=0; j<3; j++) {
-			out << cube.left[i][j] << " ";
-		}
-		for(int j=0; j<3; j++) {
-			out << cube.top[i][j] << " ";
-		}
-		for(int j=0; j<3; j++) {
-			out << cube.right[i][j] << " ";
-		}
-		for(int j=0; j<3; j++) {
-			out << cube.down[i][j] << " ";
-		}
-		out << std::endl;
-	}
-
-	for(int i=0; i<3; i++) {
-		out << "      ";
-		for(int j=0; j<3; j++) {
-			out << cube.front[i][j] << " ";
-		}
-		out << std::endl;
-	}
-
-	return out;
-}
+static_assert(std::is_trivially_copyable< RubiksCube<CUBE_SIZE> >::value, "Cube should be copied as raw bytes.");
 
 #endif
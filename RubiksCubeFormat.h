@@ -0,0 +1,96 @@
+#ifndef RUBIKSCUBEFORMAT_H_INCLUDED
+#define RUBIKSCUBEFORMAT_H_INCLUDED
+
+#include "RubiksCube.h"
+
+class RubiksCubeFormat {
+private:
+	RubiksCubeFormat() {
+	}
+
+public:
+	/* Colors of all sides separated with spaces and terminated with zero. */
+	template<int N>
+	static std::string toString(const RubiksCube<N> &cube) {
+		const RubiksCubeState<N> &state = cube.getState();
+
+		std::string result = "";
+		for(int s=0; s<6; s++) {
+			for(int i=0; i<N; i++) {
+				for(int j=0; j<N; j++) {
+					result += std::to_string((int)state.sides[s][i][j]) + " ";
+				}
+			}
+		}
+
+		/* Trim spaces. */
+		result.erase(result.size()-1, 1);
+		result += '\0';
+
+		return result;
+	}
+
+	template<int N>
+	static void fromString(RubiksCube<N> &cube, const char text[]) {
+		std::string buffer(text);
+		std::istringstream in(buffer);
+
+		RubiksCubeState<N> state = cube.getState();
+		for(int s=0; s<6; s++) {
+			for(int i=0; i<N; i++) {
+				for(int j=0; j<N; j++) {
+					int value = 0;
+					in >> value;
+					state.sides[s][i][j] = value;
+				}
+			}
+		}
+		cube.setState(state);
+	}
+};
+
+template<int N>
+std::ostream& operator<< (std::ostream &out, const RubiksCube<N> &cube) {
+	const unsigned char (*top)[N] = cube.getState().sides[RubiksCubeState<N>::TOP_SIDE];
+	const unsigned char (*left)[N] = cube.getState().sides[RubiksCubeState<N>::LEFT_SIDE];
+	const unsigned char (*right)[N] = cube.getState().sides[RubiksCubeState<N>::RIGHT_SIDE];
+	const unsigned char (*front)[N] = cube.getState().sides[RubiksCubeState<N>::FRONT_SIDE];
+	const unsigned char (*back)[N] = cube.getState().sides[RubiksCubeState<N>::BACK_SIDE];
+	const unsigned char (*down)[N] = cube.getState().sides[RubiksCubeState<N>::DOWN_SIDE];
+
+	for(int i=0; i<N; i++) {
+		out << std::string(2*N, ' ');
+		for(int j=0; j<N; j++) {
+			out << (int)back[i][j] << " ";
+		}
+		out << std::endl;
+	}
+
+	for(int i=0; i<N; i++) {
+		for(int j=0; j<N; j++) {
+			out << (int)left[i][j] << " ";
+		}
+		for(int j=0; j<N; j++) {
+			out << (int)top[i][j] << " ";
+		}
+		for(int j=0; j<N; j++) {
+			out << (int)right[i][j] << " ";
+		}
+		for(int j=0; j<N; j++) {
+			out << (int)down[i][j] << " ";
+		}
+		out << std::endl;
+	}
+
+	for(int i=0; i<N; i++) {
+		out << std::string(2*N, ' ');
+		for(int j=0; j<N; j++) {
+			out << (int)front[i][j] << " ";
+		}
+		out << std::endl;
+	}
+
+	return out;
+}
+
+#endif
@@ -1,7 +1,22 @@
 #include <map>
+#include <unordered_map>
+#include <set>
+#include <functional>
+#include <cstddef>
+#include <algorithm>
 #include <cmath>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <random>
 #include <vector>
+#include <fstream>
 #include <climits>
+#include <type_traits>
+#include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <ostream>
@@ -9,22 +24,253 @@
 #include <iostream>
 
 #include <mpi.h>
+#include <fcntl.h>
 #include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include "Common.h"
 #include "Constants.h"
 #include "RubiksCube.h"
+#include "RubiksCubeFormat.h"
+#include "Checkpoint.h"
+#include "Configuration.h"
+#include "RoundScheduler.h"
 #include "GeneticAlgorithm.h"
 #include "GeneticAlgorithmOptimizer.h"
+#include "PeepholeCompression.h"
+#include "ProgressLog.h"
+#include "Journal.h"
+
+/* Communicator of the solving group, which is the whole world except in batch mode. */
+static MPI_Comm comm = MPI_COMM_WORLD;
 
 static int rank = -1;
 static int size = 0;
 
-/** Receive buffer. */
-static char buffer[RECEIVE_BUFFER_SIZE];
+static RubiksCube<CUBE_SIZE> solved;
+static RubiksCube<CUBE_SIZE> shuffled;
+
+/* Moves applied to the cube by the worker. */
+static std::string path;
+
+/* The best path found by the workers and the distance to the solved cube after it. */
+static Chromosome solution;
+
+/* Index of the current experiment. */
+static int phase = 0;
+
+/* Round from which the experiment is continued after restart. */
+static unsigned long start = 0;
+
+/* Seed from which the random numbers of each round are derived. */
+static unsigned long seed = 0;
+
+/* States of all ranks loaded from the checkpoint. */
+static std::vector<std::string> records;
+
+static Checkpoint checkpoint(CHECKPOINT_FILE);
+
+/* Local search applied to the best chromosome of the island. */
+static const MemeticSearch<CUBE_SIZE> memetic;
+
+/* Best chromosomes published by the workers in the global migration experiments. */
+static HallOfFame hall;
+
+/* Migrants exchanged by the islands during the rounds of the ring migration experiments. */
+static NodeMigration migration;
+
+/* Definitions of the macro genes sent to the workers with each population. */
+static std::string macros;
+
+/* Improvements of the path of this rank. */
+static Journal journal;
+
+/* Paths from the journals of earlier runs for the first populations. */
+static std::vector<std::string> warm;
+
+/* Epoches done by the workers of the group, for the throughput of a parameter sweep. */
+static double performed = 0;
+
+/* Experiments differ only in the migration when the islands have their own distances. */
+static const int EXPERIMENTS = (ISLAND_METRICS == true) ? NUMBER_OF_EXPERIMENTS/2 : NUMBER_OF_EXPERIMENTS;
+
+/* Distance of the island of this rank when the islands have their own distances, the given one otherwise. */
+static DistanceType metric(DistanceType type) {
+	static const DistanceType types[] = ISLAND_DISTANCE_TYPES;
+
+	if(ISLAND_METRICS == false) {
+		return( type );
+	}
+	if(rank == ROOT_NODE) {
+		return( FINAL_DISTANCE_TYPE );
+	}
+
+	return( types[(rank-1) % (sizeof(types)/sizeof(types[0]))] );
+}
+
+/* Random numbers of each round depend only on the seed, so they can be repeated after restart. */
+static void reseed(unsigned long counter) {
+	srand( seed ^ ((phase*Configuration::instance().broadcasts+counter+1)*2654435761UL) );
+}
+
+static void save(unsigned long counter, GeneticAlgorithm &ga) {
+	/* Checkpoints are written only when the whole world solves a single cube. */
+	if(CHECKPOINT_INTERVAL <= 0 || counter%CHECKPOINT_INTERVAL != 0 || comm != MPI_COMM_WORLD) {
+		return;
+	}
+
+	checkpoint.write(phase, counter, Checkpoint::record(seed, shuffled, path, ga, macros));
+}
+
+/* Population of a rank as it was stored in the checkpoint, and the macro genes from the record of the root. */
+static void restore(int r, GeneticAlgorithm &ga) {
+	unsigned long value;
+	RubiksCube<CUBE_SIZE> cube;
+	std::string moves;
+	Checkpoint::restore(records[r], value, cube, moves, ga, r == ROOT_NODE ? &macros : NULL);
+}
+
+/* Message with unknown length. */
+static std::string receive(MPI_Comm communicator, int &source) {
+	int length = 0;
+	MPI_Status status;
+	MPI_Probe(source, DEFAULT_TAG, communicator, &status);
+	MPI_Get_count(&status, MPI_BYTE, &length);
+	source = status.MPI_SOURCE;
+
+	std::string result(length, '\0');
+	MPI_Recv(&result[0], length, MPI_BYTE, source, DEFAULT_TAG, communicator, MPI_STATUS_IGNORE);
+	return( result );
+}
+
+/* Distance of the cube of the worker after its path. Islands with different distances are compared by the final distance. */
+static double remaining() {
+	RubiksCube<CUBE_SIZE> cube = shuffled;
+	if(ISLAND_METRICS == true) {
+		cube.setDistanceType(FINAL_DISTANCE_TYPE);
+	}
+
+	return( cube.compare(solved) );
+}
+
+/* The root takes the best of the paths found by the workers. */
+static void collect() {
+	if(rank != ROOT_NODE) {
+		/* Each worker shortens its own path, so the paths are compressed in parallel. */
+		double report[2] = {remaining(), (double)path.size()};
+		path = PeepholeCompression<CUBE_SIZE>::instance().compress(path, EVALUATION_THREADS > 1 ? &TaskPool::instance() : NULL);
+		MPI_Send(report, 2, MPI_DOUBLE, ROOT_NODE, DEFAULT_TAG, comm);
+		MPI_Send(path.c_str(), path.size(), MPI_BYTE, ROOT_NODE, DEFAULT_TAG, comm);
+		return;
+	}
+
+	solution = Chromosome();
+	double original = 0;
+	for(int r=0; r<size; r++) {
+		/* Root node is not included. */
+		if(r == ROOT_NODE) {
+			continue;
+		}
+
+		double report[2] = {INVALID_FITNESS_VALUE, 0};
+		MPI_Recv(report, 2, MPI_DOUBLE, r, DEFAULT_TAG, comm, MPI_STATUS_IGNORE);
+		std::string moves = receive(comm, r);
+		if(report[0] < solution.fitness || (report[0] == solution.fitness && moves.size() < solution.command.size())) {
+			solution = Chromosome(moves, report[0]);
+			original = report[1];
+		}
+	}
+
+	std::cout << "Compression : " << original << " " << solution.command.size() << std::endl;
+	std::cout << "Solution : " << solution.fitness << " " << solution.command.size() << std::endl;
+	ProgressLog::instance().log("solution", phase, Configuration::instance().broadcasts, rank, solution.fitness, solution.command.size(), 0);
+}
+
+/* Only the changes since the last exchange with the worker are sent. The known population is the one of the worker after this message. */
+static void sendPopulation(GeneticAlgorithm &ga, GeneticAlgorithm &known, int r) {
+	const std::string &value = ga.toDelta(known);
+	MPI_Send(value.c_str(), value.size(), MPI_BYTE, r, DEFAULT_TAG, comm);
+	known.fromDelta(value.c_str());
+}
+
+/* Changes from the worker are applied to its known population. */
+static void receivePopulation(GeneticAlgorithm &ga, GeneticAlgorithm &known, int r) {
+	known.fromDelta(receive(comm, r).c_str());
+	ga = known;
+}
+
+/* Amount of work for the worker in the next round. */
+static void sendQuota(const RoundScheduler &scheduler, int r) {
+	long epoches = scheduler.getEpoches(r);
+	double budget = scheduler.getBudget();
+	MPI_Send(&epoches, 1, MPI_LONG, r, DEFAULT_TAG, comm);
+	MPI_Send(&budget, 1, MPI_DOUBLE, r, DEFAULT_TAG, comm);
+}
+
+/* Epoches done by the worker, the time spent for them and the work of its evaluation threads. The epoches are given back. */
+static double receiveReport(RoundScheduler &scheduler, int r) {
+	double report[WORKER_REPORT_SIZE];
+	MPI_Recv(report, WORKER_REPORT_SIZE, MPI_DOUBLE, r, DEFAULT_TAG, comm, MPI_STATUS_IGNORE);
+	scheduler.report(r, (long)report[0], report[1]);
+	performed += report[0];
 
-static RubiksCube solved;
-static RubiksCube shuffled;
+	if(EVALUATION_THREADS > 1) {
+		std::cout << "Utilization " << r << " : " << report[2] << "\n";
+		for(int t=0; t<EVALUATION_THREADS; t++) {
+			std::cout << "Thread " << r << " " << t << " : " << (long)report[3+3*t] << " " << (long)report[4+3*t] << " " << report[5+3*t] << "\n";
+		}
+	}
+
+	return( report[0] );
+}
+
+/* Best distance of the island, how different its chromosomes are and how long they are. Lines are flushed by the final results, and the records go to the progress log. */
+static void progress(unsigned long counter, int r, GeneticAlgorithm &ga, double epoches) {
+	int genomes = 0;
+	int fitnesses = 0;
+	double length = 0;
+	ga.diversity(genomes, fitnesses, length);
+
+	std::cout << "Worker " << r << " : " << ga.getBestChromosome().fitness << "\n";
+	std::cout << "Diversity " << r << " : " << genomes << " " << fitnesses << " " << length << "\n";
+
+	int minimum = 0;
+	int maximum = 0;
+	ga.lengths(minimum, length, maximum);
+	std::cout << "Length " << r << " : " << minimum << " " << length << " " << maximum << "\n";
+
+	const Chromosome &best = ga.getBestChromosome();
+	ProgressLog::instance().log("worker", phase, counter+1, r, best.fitness, best.command.length(), epoches*ga.size());
+}
+
+/* Macro genes from the frequent sequences of the best chromosomes of all islands. */
+static void mine(unsigned long counter, std::map<int,GeneticAlgorithm> &populations) {
+	if(MACRO_INTERVAL <= 0 || counter%MACRO_INTERVAL != 0) {
+		return;
+	}
+
+	std::vector<std::string> elites;
+	for(int r=0; r<size; r++) {
+		/* Root node is not included. */
+		if(r == ROOT_NODE) {
+			continue;
+		}
+
+		GeneticAlgorithm &ga = populations[r];
+		std::vector< std::pair<double,int> > ranked;
+		for(int i=0; i<ga.size(); i++) {
+			ranked.push_back(std::make_pair(ga.getFitness(i), i));
+		}
+		std::sort(ranked.begin(), ranked.end());
+
+		for(int i=0; i<ranked.size() && i<MACRO_ELITES; i++) {
+			elites.push_back(ga.getChromosome(ranked[i].second).command);
+		}
+	}
+
+	macros = MacroGenes<CUBE_SIZE>::mine(elites);
+}
 
 static void shuffle() {
 	if(rank != ROOT_NODE) {
@@ -32,32 +278,39 @@ static void shuffle() {
 	}
 
 	/* Cube to be solved. */
-	shuffled.shuffle(CUBE_SHUFFLING_STEPS);
+	shuffled.shuffle(Configuration::instance().shufflingSteps);
 	std::cout << "Sender : " << std::to_string(shuffled.compare(solved)) << std::endl;
 }
 
 static void master1() {
-	unsigned long counter = 0;
+	unsigned long counter = start;
 
 	if(rank != ROOT_NODE) {
 		return;
 	}
 
-	/* Send shffled cube to all other nodes. */ {
-		const std::string &value = shuffled.toString();
+	/* Send shffled cube to all other nodes. */ if(counter == 0) {
 		for(int r=0; r<size; r++) {
 			/* Root node is not included. */
 			if(r == ROOT_NODE) {
 				continue;
 			}
 
-			MPI_Send(value.c_str(), value.size(), MPI_BYTE, r, DEFAULT_TAG, MPI_COMM_WORLD);
+			MPI_Send(&shuffled.getState(), sizeof(RubiksCubeState<CUBE_SIZE>), MPI_BYTE, r, DEFAULT_TAG, comm);
 		}
 	}
 
+	RoundScheduler scheduler;
 	std::map<int,GeneticAlgorithm> populations;
+	std::map<int,GeneticAlgorithm> known;
+	GeneticAlgorithm none;
+	macros = "";
+	for(int r=0; counter>0 && r<size; r++) {
+		restore(r, r==ROOT_NODE ? none : populations[r]);
+	}
 	do {
-		std::cout << "Round : " << (counter+1) << std::endl;
+		reseed(counter);
+		std::cout << "Round : " << (counter+1) << "\n";
 
 		/* Send GA population to all other nodes. */
 		for(int r=0; r<size; r++) {
@@ -69,23 +322,25 @@ static void master1() {
 			GeneticAlgorithm ga;
 			if(counter == 0) {
 				GeneticAlgorithmOptimizer::addEmptyCommand(ga, solved, shuffled);
-				GeneticAlgorithmOptimizer::addRandomCommands(ga, solved, shuffled, LOCAL_POPULATION_SIZE);
+				GeneticAlgorithmOptimizer::addRandomCommands(ga, solved, shuffled, Configuration::instance().populationSize);
+				GeneticAlgorithmOptimizer::addKnownCommands(ga, solved, shuffled, warm);
 				populations[r] = ga;
-			} else {
+			} else if(migration.isOpen() == false) {
 				/* Ring migration strategy. */
 				int next = (r+1) % size;
 				while(next == ROOT_NODE) {
 					next = (next+1) % size;
 				}
 
-				if(RANDOM_TRAVELER == true) {
+				if(Configuration::instance().randomTraveler == true) {
 					populations[r].replaceWorst(populations[next].getRandomChromosome());
 				} else {
 					populations[r].replaceWorst(populations[next].getBestChromosome());
 				}
 			}
-			const std::string &value = populations[r].toString();
-			MPI_Send(value.c_str(), value.size(), MPI_BYTE, r, DEFAULT_TAG, MPI_COMM_WORLD);
+			sendPopulation(populations[r], known[r], r);
+			sendQuota(scheduler, r);
+			MPI_Send(macros.c_str(), macros.size(), MPI_BYTE, r, DEFAULT_TAG, comm);
 		}
 
 		/* Collect results from all other nodes. */
@@ -96,39 +351,51 @@ static void master1() {
 			}
 
 			GeneticAlgorithm ga;
-			MPI_Recv(buffer, RECEIVE_BUFFER_SIZE, MPI_BYTE, r, DEFAULT_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-			ga.fromString(buffer);
+			receivePopulation(ga, known[r], r);
+			double epoches = receiveReport(scheduler, r);
 			populations[r] = ga;
-			std::cout << "Worker " << r << " : " << ga.getBestChromosome().fitness << std::endl;
+			progress(counter, r, ga, epoches);
 		}
 
 		counter++;
-	} while(counter < NUMBER_OF_BROADCASTS);
+		mine(counter, populations);
+
+		/* Islands are stored by the workers. */
+		save(counter, none);
+	} while(counter < Configuration::instance().broadcasts);
+
+	collect();
 }
 
 static void master2() {
-	unsigned long counter = 0;
+	unsigned long counter = start;
 
 	if(rank != ROOT_NODE) {
 		return;
 	}
 
-	/* Send shffled cube to all other nodes. */ {
-		const std::string &value = shuffled.toString();
+	/* Send shffled cube to all other nodes. */ if(counter == 0) {
 		for(int r=0; r<size; r++) {
 			/* Root node is not included. */
 			if(r == ROOT_NODE) {
 				continue;
 			}
 
-			MPI_Send(value.c_str(), value.size(), MPI_BYTE, r, DEFAULT_TAG, MPI_COMM_WORLD);
+			MPI_Send(&shuffled.getState(), sizeof(RubiksCubeState<CUBE_SIZE>), MPI_BYTE, r, DEFAULT_TAG, comm);
 		}
 	}
 
 	GeneticAlgorithm global;
+	RoundScheduler scheduler;
 	std::map<int,GeneticAlgorithm> populations;
+	std::map<int,GeneticAlgorithm> known;
+	macros = "";
+	for(int r=0; counter>0 && r<size; r++) {
+		restore(r, r==ROOT_NODE ? global : populations[r]);
+	}
 	do {
-		std::cout << "Round : " << (counter+1) << std::endl;
+		reseed(counter);
+		std::cout << "Round : " << (counter+1) << "\n";
 
 		for(int r=0; r<size; r++) {
 			/* Root node is not included. */
@@ -138,20 +405,22 @@ static void master2() {
 
 			if(counter == 0) {
 				GeneticAlgorithmOptimizer::addEmptyCommand(global, solved, shuffled);
-				GeneticAlgorithmOptimizer::addRandomCommands(global, solved, shuffled, LOCAL_POPULATION_SIZE*size);
+				GeneticAlgorithmOptimizer::addRandomCommands(global, solved, shuffled, Configuration::instance().populationSize*size);
 				GeneticAlgorithm ga;
-				global.subset(ga, LOCAL_POPULATION_SIZE);
+				global.subset(ga, Configuration::instance().populationSize);
+				GeneticAlgorithmOptimizer::addKnownCommands(ga, solved, shuffled, warm);
 				populations[r] = ga;
 			} else {
 				//TODO Find better way to control this probability.
-				if(rand()%(NUMBER_OF_BROADCASTS/10) == 0) {
+				if(rand()%std::max(Configuration::instance().broadcasts/10, 1L) == 0) {
 					GeneticAlgorithm ga;
-					global.subset(ga, LOCAL_POPULATION_SIZE);
+					global.subset(ga, Configuration::instance().populationSize);
 					populations[r] = ga;
 				}
 			}
-			const std::string &value = populations[r].toString();
-			MPI_Send(value.c_str(), value.size(), MPI_BYTE, r, DEFAULT_TAG, MPI_COMM_WORLD);
+			sendPopulation(populations[r], known[r], r);
+			sendQuota(scheduler, r);
+			MPI_Send(macros.c_str(), macros.size(), MPI_BYTE, r, DEFAULT_TAG, comm);
 		}
 
 		/* Collect results from all other nodes. */
@@ -162,77 +431,863 @@ static void master2() {
 			}
 
 			GeneticAlgorithm ga;
-			MPI_Recv(buffer, RECEIVE_BUFFER_SIZE, MPI_BYTE, r, DEFAULT_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-			ga.fromString(buffer);
+			receivePopulation(ga, known[r], r);
+			double epoches = receiveReport(scheduler, r);
 			populations[r] = ga;
-			if(ga.getBestFitness() < global.getBestFitness()) {
-				global.setChromosome( ga.getBestChromosome() );
+			Chromosome best = ga.getBestChromosome();
+			if(ISLAND_METRICS == true) {
+				best = GeneticAlgorithmOptimizer::rescore(best, solved, shuffled);
+			}
+			if(best.fitness < global.getBestFitness() && global.contains(best) == false) {
+				global.setChromosome( best );
 			}
-			std::cout << "Worker " << r << " : " << ga.getBestChromosome().fitness << std::endl;
+			progress(counter, r, ga, epoches);
+		}
+
+		/* Improvements published during the round. */
+		std::vector<Chromosome> elites;
+		hall.pull(elites);
+		if(elites.size() > 0 && elites[0].fitness < global.getBestFitness() && global.contains(elites[0]) == false) {
+			global.setChromosome( elites[0] );
 		}
 
-		std::cout << "Global : " << global.getBestChromosome().fitness << std::endl;
+		std::cout << "Global : " << global.getBestChromosome().fitness << "\n";
+		ProgressLog::instance().log("global", phase, counter+1, rank, global.getBestFitness(), global.getBestChromosome().command.length(), 0);
 
 
 		counter++;
-	} while(counter < NUMBER_OF_BROADCASTS);
+		mine(counter, populations);
+		save(counter, global);
+	} while(counter < Configuration::instance().broadcasts);
+
+	collect();
+}
+
+/* The island evolves while its result is sent and until the next population comes, and the chromosomes of this population which are better than the worst ones of the island are merged in it. */
+static void overlap(GeneticAlgorithm &ga, GeneticAlgorithm &known, MPI_Request sends[2], double &epoches, double &seconds) {
+	double begin = MPI_Wtime();
+
+	/* Population of any size is received when it has arrived. */
+	int arrived = 0;
+	int sent = 0;
+	do {
+		/* The cube moves only by the best chromosome of the whole round, together with the path. */
+		RubiksCube<CUBE_SIZE> cube = shuffled;
+		epoches += GeneticAlgorithmOptimizer::optimize(ga, solved, cube, WORKER_OVERLAP_EPOCHES);
+		MPI_Testall(2, sends, &sent, MPI_STATUSES_IGNORE);
+		MPI_Iprobe(ROOT_NODE, DEFAULT_TAG, comm, &arrived, MPI_STATUS_IGNORE);
+	} while(arrived == 0);
+	MPI_Waitall(2, sends, MPI_STATUSES_IGNORE);
+
+	seconds += MPI_Wtime() - begin;
+
+	int source = ROOT_NODE;
+	known.fromDelta(receive(comm, source).c_str());
+	GeneticAlgorithm migrants;
+	migrants = known;
+	if(ISLAND_METRICS == true) {
+		GeneticAlgorithmOptimizer::rescore(migrants, solved, shuffled);
+	}
+	for(int i=0; i<migrants.size(); i++) {
+		if(migrants.getFitness(i) < ga.getWorstChromosome().fitness) {
+			ga.replaceWorst(migrants.getChromosome(i));
+		}
+	}
 }
 
 static void slave1() {
-	unsigned long counter = 0;
+	unsigned long counter = start;
 
 	if(rank == ROOT_NODE) {
 		return;
 	}
 
-	MPI_Recv(buffer, RECEIVE_BUFFER_SIZE, MPI_BYTE, ROOT_NODE, DEFAULT_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-	shuffled.fromString(buffer);
+	/* After restart the cube is restored from the checkpoint. */
+	if(counter == 0) {
+		RubiksCubeState<CUBE_SIZE> state;
+		MPI_Recv(&state, sizeof(RubiksCubeState<CUBE_SIZE>), MPI_BYTE, ROOT_NODE, DEFAULT_TAG, comm, MPI_STATUS_IGNORE);
+		shuffled.setState(state);
+		path = "";
+	}
+
+	/* The result stays in its own buffer while it is sent and the island is evolved further. */
+	GeneticAlgorithm ga;
+	GeneticAlgorithm known;
+	std::string result;
+	double report[WORKER_REPORT_SIZE] = {0};
+	MPI_Request sends[2] = {MPI_REQUEST_NULL, MPI_REQUEST_NULL};
+	bool pipelined = false;
+	double recorded = INVALID_FITNESS_VALUE;
 
 	do {
-		GeneticAlgorithm ga;
-		MPI_Recv(buffer, RECEIVE_BUFFER_SIZE, MPI_BYTE, ROOT_NODE, DEFAULT_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-		ga.fromString(buffer);
+		reseed(counter);
+
+		/* Epoches and time of the evolution during the transfers are reported with the next round. */
+		double overlapped[2] = {0, 0};
+		if(pipelined == true) {
+			overlap(ga, known, sends, overlapped[0], overlapped[1]);
+		} else {
+			receivePopulation(ga, known, ROOT_NODE);
+		}
+
+		long epoches = 0;
+		double budget = 0;
+		MPI_Recv(&epoches, 1, MPI_LONG, ROOT_NODE, DEFAULT_TAG, comm, MPI_STATUS_IGNORE);
+		MPI_Recv(&budget, 1, MPI_DOUBLE, ROOT_NODE, DEFAULT_TAG, comm, MPI_STATUS_IGNORE);
+
+		int source = ROOT_NODE;
+		MacroGenes<CUBE_SIZE>::instance().install(receive(comm, source));
+		GeneticAlgorithm::setMacros(MacroGenes<CUBE_SIZE>::instance().getSymbols());
+
+		/* Migrants and new chromosomes from the root are scored by the distance of this island. */
+		if(ISLAND_METRICS == true && pipelined == false) {
+			GeneticAlgorithmOptimizer::rescore(ga, solved, shuffled);
+		}
 
 		/* Calculate as regular node. */
-		GeneticAlgorithmOptimizer::optimize(ga, solved, shuffled, LOCAL_OPTIMIZATION_EPOCHES);
+		double begin = MPI_Wtime();
+		if(EVALUATION_THREADS > 1) {
+			TaskPool::instance().reset();
+		}
+		report[0] = overlapped[0] + GeneticAlgorithmOptimizer::optimize(ga, solved, shuffled, epoches, budget, &memetic, hall.isOpen() ? &hall : NULL, migration.isOpen() ? &migration : NULL);
+		report[1] = overlapped[1] + MPI_Wtime() - begin;
+		if(EVALUATION_THREADS > 1) {
+			report[2] = TaskPool::instance().getUtilization();
+			for(int t=0; t<EVALUATION_THREADS; t++) {
+				report[3+3*t] = TaskPool::instance().getExecuted(t);
+				report[4+3*t] = TaskPool::instance().getStolen(t);
+				report[5+3*t] = TaskPool::instance().getBusy(t);
+			}
+		}
+		path += ga.getBestChromosome().command;
 
-		std::string result = ga.toString();
-		MPI_Send(result.c_str(), result.size(), MPI_BYTE, ROOT_NODE, DEFAULT_TAG, MPI_COMM_WORLD);
+		/* Shorter distance of the path is kept in the journal of the rank. */
+		double distance = remaining();
+		if(distance < recorded) {
+			int member = 0;
+			MPI_Comm_rank(MPI_COMM_WORLD, &member);
+			journal.append(distance, member, phase, counter+1, path);
+			recorded = distance;
+		}
+
+		/* Only the changes since the last exchange with the root are sent. */
+		result = ga.toDelta(known);
+		known.fromDelta(result.c_str());
+		if(WORKER_OVERLAP_EPOCHES > 0) {
+			MPI_Isend(result.c_str(), result.size(), MPI_BYTE, ROOT_NODE, DEFAULT_TAG, comm, &sends[0]);
+			MPI_Isend(report, WORKER_REPORT_SIZE, MPI_DOUBLE, ROOT_NODE, DEFAULT_TAG, comm, &sends[1]);
+			pipelined = true;
+		} else {
+			MPI_Send(result.c_str(), result.size(), MPI_BYTE, ROOT_NODE, DEFAULT_TAG, comm);
+			MPI_Send(report, WORKER_REPORT_SIZE, MPI_DOUBLE, ROOT_NODE, DEFAULT_TAG, comm);
+		}
 
 		counter++;
-	} while(counter < NUMBER_OF_BROADCASTS);
+		save(counter, ga);
+	} while(counter < Configuration::instance().broadcasts);
+	MPI_Waitall(2, sends, MPI_STATUSES_IGNORE);
+
+	collect();
 }
 
 static void slave2() {
 	slave1();
 }
 
+/* Migration strategy is changed on each experiment and the distance in the middle of the experiments. */
+static void experiment(int index) {
+	/* The first half of the experiments is with Hausdorff distance and the second half is with Euclidean distance. */
+	DistanceType type = metric( (index < NUMBER_OF_EXPERIMENTS/2) ? HAUSDORFF : EUCLIDEAN );
+	solved.setDistanceType(type);
+	shuffled.setDistanceType(type);
+
+	if(index%2 == 0) {
+		if(NODE_MIGRATION_INTERVAL > 0) {
+			migration.open(comm, ROOT_NODE);
+		}
+		master1();
+		slave1();
+		migration.close();
+	} else {
+		if(HALL_OF_FAME_INTERVAL > 0) {
+			hall.open(comm, ROOT_NODE);
+		}
+		master2();
+		slave2();
+		hall.close();
+	}
+}
+
+/* Statistics over the trials of each experiment. */
+static void summary(const std::vector<double> &results) {
+	std::cout << "Summary : experiment distance trials mean deviation minimum maximum length seconds" << std::endl;
+
+	for(int e=0; e<EXPERIMENTS; e++) {
+		double sum = 0;
+		double squares = 0;
+		double minimum = INVALID_FITNESS_VALUE;
+		double maximum = 0;
+		double length = 0;
+		double seconds = 0;
+
+		for(int t=0; t<NUMBER_OF_TRIALS; t++) {
+			int c = t*EXPERIMENTS + e;
+			double distance = results[3*c];
+
+			sum += distance;
+			squares += distance*distance;
+			if(distance < minimum) {
+				minimum = distance;
+			}
+			if(distance > maximum) {
+				maximum = distance;
+			}
+			length += results[3*c+1];
+			seconds += results[3*c+2];
+		}
+
+		double mean = sum / NUMBER_OF_TRIALS;
+		double variance = squares/NUMBER_OF_TRIALS - mean*mean;
+
+		std::cout << "Summary : " << (e%2==0 ? "ring" : "global") << " " << (ISLAND_METRICS == true ? "mixed" : (e<NUMBER_OF_EXPERIMENTS/2 ? "hausdorff" : "euclidean"));
+		std::cout << " " << NUMBER_OF_TRIALS << " " << mean << " " << sqrt(variance>0 ? variance : 0) << " " << minimum << " " << maximum;
+		std::cout << " " << (length/NUMBER_OF_TRIALS) << " " << (seconds/NUMBER_OF_TRIALS) << std::endl;
+	}
+}
+
+/* The world is divided in groups of consecutive ranks, which become the solving groups, and the color of this rank is given back. */
+static int split(int groups) {
+	int color = rank * groups / size;
+	MPI_Comm_split(MPI_COMM_WORLD, color, rank, &comm);
+	MPI_Comm_rank(comm, &rank);
+	MPI_Comm_size(comm, &size);
+
+	/* Rounds of the groups are not reported. */
+	std::cout.setstate(std::ios::failbit);
+
+	return( color );
+}
+
+/* The world is the solving group again. */
+static void join(int world) {
+	std::cout.clear();
+	MPI_Comm_free(&comm);
+	comm = MPI_COMM_WORLD;
+	rank = world;
+	MPI_Comm_size(comm, &size);
+}
+
+/* All experiments and their trials run at the same time on separate groups of processes. */
+static void concurrent() {
+	const int configurations = EXPERIMENTS * NUMBER_OF_TRIALS;
+
+	/* Each group needs a root and at least one worker. */
+	int groups = size / 2;
+	if(groups > configurations) {
+		groups = configurations;
+	}
+	if(groups < 1) {
+		if(rank == ROOT_NODE) {
+			std::cerr << "Concurrent experiments need at least two processes." << std::endl;
+		}
+		return;
+	}
+
+	/* All experiments solve the same cube. */
+	shuffle();
+	RubiksCubeState<CUBE_SIZE> state = shuffled.getState();
+	MPI_Bcast(&state, sizeof(RubiksCubeState<CUBE_SIZE>), MPI_BYTE, ROOT_NODE, MPI_COMM_WORLD);
+	shuffled.setState(state);
+
+	int world = rank;
+	int color = split(groups);
+
+	/* Distance, solution length and time for each configuration. */
+	std::vector<double> results(3*configurations, 0.0);
+	for(int c=color; c<configurations; c+=groups) {
+		double begin = MPI_Wtime();
+
+		/* Each trial has its own random numbers. */
+		phase = c;
+		start = 0;
+		experiment(c % EXPERIMENTS);
+
+		if(rank == ROOT_NODE) {
+			results[3*c] = solution.fitness;
+			results[3*c+1] = solution.command.size();
+			results[3*c+2] = MPI_Wtime() - begin;
+		}
+	}
+
+	join(world);
+
+	/* Only roots of the groups have non-zero values. */
+	std::vector<double> totals(results.size(), 0.0);
+	MPI_Reduce(&results[0], &totals[0], results.size(), MPI_DOUBLE, MPI_SUM, ROOT_NODE, comm);
+
+	if(rank == ROOT_NODE) {
+		summary(totals);
+	}
+}
+
+/* Points of the grid given by lines NAME = VALUE VALUE ..., as lines NAME=VALUE, with the last parameter changed first. */
+static std::vector<std::string> grid(const std::string &text, std::string &error) {
+	std::vector<std::string> points(1, "");
+
+	std::istringstream in(text);
+	std::string line;
+	while(std::getline(in, line)) {
+		if(line.find_first_not_of(" \t\r") == std::string::npos || line[line.find_first_not_of(" \t")] == '#') {
+			continue;
+		}
+
+		std::string::size_type equals = line.find('=');
+		std::string name;
+		std::vector<std::string> values;
+		if(equals != std::string::npos) {
+			std::istringstream(line.substr(0, equals)) >> name;
+			std::istringstream words(line.substr(equals+1));
+			std::string value;
+			while(words >> value) {
+				values.push_back(value);
+			}
+		}
+		if(name == "" || values.size() == 0) {
+			error = line;
+			return( std::vector<std::string>() );
+		}
+
+		std::vector<std::string> expanded;
+		for(int p=0; p<points.size(); p++) {
+			for(int v=0; v<values.size(); v++) {
+				expanded.push_back(points[p] + name + "=" + values[v] + "\n");
+			}
+		}
+		points = expanded;
+	}
+
+	return( points );
+}
+
+/* Points of a parameter grid run at the same time on separate groups of processes, all of them on the same cube. */
+static void sweep(const std::string &base, const std::string &text) {
+	std::string error;
+	std::vector<std::string> points = grid(text, error);
+	for(int c=0; error=="" && c<points.size(); c++) {
+		Configuration::instance().reset();
+		Configuration::instance().apply(base + points[c], error);
+	}
+	Configuration::instance().reset();
+	Configuration::instance().apply(base, error);
+	if(error != "") {
+		if(rank == ROOT_NODE) {
+			std::cerr << "Wrong sweep line : " << error << std::endl;
+		}
+		return;
+	}
+
+	/* Each group needs a root and at least one worker. */
+	int groups = size / 2;
+	if(groups > points.size()) {
+		groups = points.size();
+	}
+	if(groups < 1) {
+		if(rank == ROOT_NODE) {
+			std::cerr << "Parameter sweep needs at least two processes." << std::endl;
+		}
+		return;
+	}
+
+	/* The cube of each point depends only on its number of shuffling steps. */
+	MPI_Bcast(&seed, 1, MPI_UNSIGNED_LONG, ROOT_NODE, MPI_COMM_WORLD);
+
+	int world = rank;
+	int color = split(groups);
+
+	/* Distance, solution length, time and epoches per second for each point. */
+	std::vector<double> results(4*points.size(), 0.0);
+	for(int c=color; c<points.size(); c+=groups) {
+		std::string ignored;
+		Configuration::instance().reset();
+		Configuration::instance().apply(base + points[c], ignored);
+
+		shuffled = solved;
+		srand( seed );
+		shuffle();
+
+		double begin = MPI_Wtime();
+		phase = c;
+		start = 0;
+		performed = 0;
+		experiment(SWEEP_EXPERIMENT);
+
+		if(rank == ROOT_NODE) {
+			double seconds = MPI_Wtime() - begin;
+			results[4*c] = solution.fitness;
+			results[4*c+1] = solution.command.size();
+			results[4*c+2] = seconds;
+			results[4*c+3] = seconds>0 ? performed/seconds : 0;
+		}
+	}
+
+	join(world);
+	std::string ignored;
+	Configuration::instance().reset();
+	Configuration::instance().apply(base, ignored);
+
+	/* Only roots of the groups have non-zero values. */
+	std::vector<double> totals(results.size(), 0.0);
+	MPI_Reduce(&results[0], &totals[0], results.size(), MPI_DOUBLE, MPI_SUM, ROOT_NODE, comm);
+
+	if(rank != ROOT_NODE) {
+		return;
+	}
+
+	std::cout << "Sweep : point distance length seconds throughput parameters" << std::endl;
+	for(int c=0; c<points.size(); c++) {
+		std::string parameters = points[c];
+		std::replace(parameters.begin(), parameters.end(), '\n', ' ');
+		std::cout << "Sweep : " << c << " " << totals[4*c] << " " << totals[4*c+1] << " " << totals[4*c+2] << " " << totals[4*c+3] << " " << parameters << std::endl;
+	}
+}
+
+/* Scramble given as moves or as colors of the sides (numbers separated with spaces) in the order of RubiksCubeFormat::toString. */
+static bool scramble(const std::string &line, RubiksCube<CUBE_SIZE> &cube) {
+	const int FACELETS = 6 * CUBE_SIZE * CUBE_SIZE;
+	const std::string &alphabet = RubiksCube<CUBE_SIZE>::alphabet();
+
+	std::istringstream words(line);
+	std::string word;
+	int numbers = 0;
+	while(words >> word) {
+		if(word.find_first_not_of("0123456789") != std::string::npos) {
+			numbers = 0;
+			break;
+		}
+		numbers++;
+	}
+
+	if(numbers <= 1) {
+		std::string moves = "";
+		for(int i=0; i<line.size(); i++) {
+			if(isspace(line[i])) {
+				continue;
+			}
+			if(line[i] != NONE && alphabet.find(line[i]) == std::string::npos) {
+				return( false );
+			}
+			moves += line[i];
+		}
+
+		cube.execute(moves);
+		return( true );
+	}
+
+	/* Each of the six colors should be on exactly one side worth of places. */
+	int counters[7] = {0, 0, 0, 0, 0, 0, 0};
+	int value = 0;
+	int count = 0;
+	std::istringstream in(line);
+	while(in >> value) {
+		if(value < RED || value > PURPLE || ++counters[value] > CUBE_SIZE*CUBE_SIZE) {
+			return( false );
+		}
+		count++;
+	}
+	if(count != FACELETS || in.eof() == false) {
+		return( false );
+	}
+
+	RubiksCubeFormat::fromString(cube, line.c_str());
+	return( true );
+}
+
+/* Streams scrambles to the solving groups and writes their results in the order of the input. */
+static void dispatch(const char input[], const char output[], int groups) {
+	std::ifstream in(input);
+	std::ofstream out(output);
+	if(!in || !out) {
+		std::cerr << "Batch files can not be opened." << std::endl;
+		MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+	}
+
+	long index = 0;
+	long written = 0;
+	std::map<long,std::string> results;
+	while(groups > 0) {
+		/* Each request of a group has the result of its previous scramble. */
+		int source = MPI_ANY_SOURCE;
+		std::string result = receive(MPI_COMM_WORLD, source);
+		if(result != "") {
+			long value = -1;
+			std::istringstream(result) >> value;
+			results[value] = result;
+		}
+
+		std::string task = "-1";
+		std::string line;
+		while(std::getline(in, line)) {
+			if(line.find_first_not_of(" \t\r") == std::string::npos || line[0] == '#') {
+				continue;
+			}
+
+			RubiksCube<CUBE_SIZE> cube;
+			if(scramble(line, cube) == true) {
+				task = std::to_string(index) + " " + std::string(RubiksCubeFormat::toString(cube).c_str());
+				index++;
+				break;
+			}
+
+			results[index] = std::to_string(index) + " invalid";
+			index++;
+		}
+
+		if(task == "-1") {
+			groups--;
+		}
+		MPI_Send(task.c_str(), task.size(), MPI_BYTE, source, DEFAULT_TAG, MPI_COMM_WORLD);
+
+		for(; results.count(written)>0; written++) {
+			out << results[written] << std::endl;
+			results.erase(written);
+		}
+	}
+
+	/* Invalid scrambles at the end of the input. */
+	for(; results.count(written)>0; written++) {
+		out << results[written] << std::endl;
+		results.erase(written);
+	}
+}
+
+/* Solving group takes scrambles from the dispatcher until there are no more. */
+static void group() {
+	std::string result = "";
+
+	while(true) {
+		std::string task;
+		if(rank == ROOT_NODE) {
+			MPI_Send(result.c_str(), result.size(), MPI_BYTE, ROOT_NODE, DEFAULT_TAG, MPI_COMM_WORLD);
+			int source = ROOT_NODE;
+			task = receive(MPI_COMM_WORLD, source);
+		}
+
+		int length = task.size();
+		MPI_Bcast(&length, 1, MPI_INT, ROOT_NODE, comm);
+		task.resize(length);
+		MPI_Bcast(&task[0], length, MPI_BYTE, ROOT_NODE, comm);
+
+		long index = -1;
+		std::istringstream in(task);
+		in >> index;
+		if(index < 0) {
+			break;
+		}
+
+		if(rank == ROOT_NODE) {
+			std::string facelets;
+			std::getline(in, facelets);
+			RubiksCubeFormat::fromString(shuffled, facelets.c_str());
+		}
+
+		/* Each scramble has its own random numbers. */
+		phase = index;
+		start = 0;
+		if(NODE_MIGRATION_INTERVAL > 0) {
+			migration.open(comm, ROOT_NODE);
+		}
+		master1();
+		slave1();
+		migration.close();
+
+		if(rank == ROOT_NODE) {
+			result = std::to_string(index) + " " + std::to_string(solution.fitness) + " " + std::to_string(solution.command.size()) + " " + solution.command;
+		}
+	}
+}
+
+/* Many scrambles are solved by independent groups of processes. */
+static void batch(const char input[], const char output[]) {
+	if(size < 3) {
+		if(rank == ROOT_NODE) {
+			std::cerr << "Batch mode needs at least three processes." << std::endl;
+		}
+		return;
+	}
+
+	int groups = (size-1) / GROUP_SIZE;
+	if(groups < 1) {
+		groups = 1;
+	}
+
+	/* Last ranks, which are not enough for a whole group, join the previous group. */
+	int color = MPI_UNDEFINED;
+	if(rank != ROOT_NODE) {
+		color = (rank-1) / GROUP_SIZE;
+		if(color >= groups) {
+			color = groups - 1;
+		}
+	}
+	MPI_Comm_split(MPI_COMM_WORLD, color, rank, &comm);
+
+	if(rank == ROOT_NODE) {
+		dispatch(input, output, groups);
+		comm = MPI_COMM_WORLD;
+		return;
+	}
+
+	/* Rounds of the groups are not reported. */
+	std::cout.setstate(std::ios::failbit);
+
+	MPI_Comm_rank(comm, &rank);
+	MPI_Comm_size(comm, &size);
+	solved.setDistanceType(metric(BATCH_DISTANCE_TYPE));
+	shuffled.setDistanceType(metric(BATCH_DISTANCE_TYPE));
+
+	group();
+
+	MPI_Comm_free(&comm);
+	comm = MPI_COMM_WORLD;
+}
+
+/* Table of the cubes near the solved one is built by the root and mapped by all ranks. */
+static void prepare() {
+	if(FINISHING_TABLE_DEPTH <= 0) {
+		return;
+	}
+
+	FinishingTable<CUBE_SIZE> &table = FinishingTable<CUBE_SIZE>::instance();
+	if(rank == ROOT_NODE && table.open(FINISHING_TABLE_FILE, FINISHING_TABLE_DEPTH) == false) {
+		FinishingTable<CUBE_SIZE>::build(FINISHING_TABLE_FILE, FINISHING_TABLE_DEPTH);
+		table.open(FINISHING_TABLE_FILE, FINISHING_TABLE_DEPTH);
+	}
+	MPI_Barrier(MPI_COMM_WORLD);
+
+	if(rank != ROOT_NODE) {
+		table.open(FINISHING_TABLE_FILE, FINISHING_TABLE_DEPTH);
+	}
+}
+
+/* Text of the root is given to all ranks. */
+static std::string share(const std::string &text) {
+	long length = text.size();
+	MPI_Bcast(&length, 1, MPI_LONG, ROOT_NODE, MPI_COMM_WORLD);
+
+	std::vector<char> bytes(text.begin(), text.end());
+	bytes.resize(length);
+	if(length > 0) {
+		MPI_Bcast(&bytes[0], length, MPI_CHAR, ROOT_NODE, MPI_COMM_WORLD);
+	}
+
+	return( std::string(bytes.begin(), bytes.end()) );
+}
+
+/* Whole file, which is read only by the root. */
+static bool load(const char name[], std::string &text) {
+	if(rank != ROOT_NODE) {
+		return( true );
+	}
+
+	std::ifstream in(name);
+	if(!in) {
+		std::cerr << "File can not be read : " << name << std::endl;
+		return( false );
+	}
+
+	std::ostringstream out;
+	out << in.rdbuf();
+	text += out.str() + "\n";
+	return( true );
+}
+
+/* Entries of a journal as lines: rank, experiment, round, wall time, distance, length and moves. */
+static void dump(const char name[]) {
+	std::vector<Journal::Record> records;
+	if(Journal::read(name, records) == false) {
+		std::cerr << "Journal can not be read : " << name << std::endl;
+		return;
+	}
+
+	std::cout.precision(15);
+	for(int i=0; i<records.size(); i++) {
+		const Journal::Record &record = records[i];
+		std::cout << record.rank << " " << record.phase << " " << record.round << " " << record.time << " " << record.fitness << " " << record.commands.length() << " " << record.commands << "\n";
+	}
+	std::cout.flush();
+}
+
+/* Shortest distances from the journals, one path on each line, different from each other. */
+static std::string remember(const std::vector<std::string> &names) {
+	std::vector< std::pair<double,std::string> > ranked;
+	for(int n=0; n<names.size(); n++) {
+		std::vector<Journal::Record> records;
+		if(Journal::read(names[n], records) == false) {
+			std::cerr << "Journal can not be read : " << names[n] << std::endl;
+		}
+		for(int i=0; i<records.size(); i++) {
+			ranked.push_back(std::make_pair(records[i].fitness, records[i].commands));
+		}
+	}
+	std::sort(ranked.begin(), ranked.end());
+	ranked.erase(std::unique(ranked.begin(), ranked.end()), ranked.end());
+
+	std::string result = "";
+	for(int i=0; i<ranked.size() && i<WARM_START_COUNT; i++) {
+		result += ranked[i].second + "\n";
+	}
+
+	return( result );
+}
+
 int main(int argc, char **argv) {
-	MPI_Init (&argc, &argv);
+	/* Only the main thread calls MPI when the islands are evolved by many threads. */
+	int provided = 0;
+	MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
 	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
 	MPI_Comm_size(MPI_COMM_WORLD, &size);
 
-	srand( time(NULL)^getpid() );
+	/* Threads are used only when the MPI library allows them. */
+	if(provided < MPI_THREAD_FUNNELED && (PANMICTIC_THREADS > 1 || EVALUATION_THREADS > 1)) {
+		if(rank == ROOT_NODE) {
+			std::cerr << "MPI library without threads : " << provided << std::endl;
+		}
+		MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+	}
 
-	/* Firs process will distribute the working tasks. */
-	shuffle();
+	GeneticAlgorithm::setAlphabet(RubiksCube<CUBE_SIZE>::alphabet());
 
-	solved.setDistanceType(HAUSDORFF);
-	shuffled.setDistanceType(HAUSDORFF);
+	seed = time(NULL)^getpid();
+	srand( seed );
 
-	master1();
-	slave1();
-	master2();
-	slave2();
+	bool resume = false;
+	bool parallel = false;
+	const char *input = NULL;
+	const char *output = NULL;
+	const char *grid = NULL;
+	const char *journaled = NULL;
+	std::vector<std::string> journals;
+	std::string settings;
+	bool loaded = true;
+	for(int i=1; i<argc; i++) {
+		if(std::string(argv[i]) == "--resume") {
+			resume = true;
+		}
+		if(std::string(argv[i]) == "--batch" && i+2 < argc) {
+			input = argv[++i];
+			output = argv[++i];
+		}
+		if(std::string(argv[i]) == "--concurrent") {
+			parallel = true;
+		}
+		if(std::string(argv[i]) == "--config" && i+1 < argc) {
+			loaded = load(argv[++i], settings) && loaded;
+		}
+		if(std::string(argv[i]) == "--set" && i+1 < argc) {
+			settings += std::string(argv[++i]) + "\n";
+		}
+		if(std::string(argv[i]) == "--sweep" && i+1 < argc) {
+			grid = argv[++i];
+		}
+		if(std::string(argv[i]) == "--journal-dump" && i+1 < argc) {
+			journaled = argv[++i];
+		}
+		if(std::string(argv[i]) == "--warm" && i+1 < argc) {
+			journals.push_back(argv[++i]);
+		}
+	}
 
-	solved.setDistanceType(EUCLIDEAN);
-	shuffled.setDistanceType(EUCLIDEAN);
+	if(journaled != NULL) {
+		if(rank == ROOT_NODE) {
+			dump(journaled);
+		}
+		MPI_Finalize();
+		return( EXIT_SUCCESS );
+	}
 
-	master1();
-	slave1();
-	master2();
-	slave2();
+	/* Parameters of the root are used by all ranks. */
+	std::string error;
+	settings = share(settings);
+	if(loaded == false || Configuration::instance().apply(settings, error) == false) {
+		if(rank == ROOT_NODE && loaded == true) {
+			std::cerr << "Wrong parameter : " << error << std::endl;
+		}
+		MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+	}
+
+	/* Best paths of earlier runs are given to all ranks, since any rank can be the root of a group. */
+	std::istringstream paths( share(rank == ROOT_NODE ? remember(journals) : "") );
+	for(std::string line; std::getline(paths, line);) {
+		warm.push_back(line);
+	}
+
+	if(rank != ROOT_NODE && std::string(JOURNAL_FILE) != "" && journal.open(std::string(JOURNAL_FILE) + "." + std::to_string(rank)) == false) {
+		std::cerr << "Journal can not be written : " << JOURNAL_FILE << "." << rank << std::endl;
+	}
+
+	prepare();
+	hall.create(MPI_COMM_WORLD);
+	migration.create(MPI_COMM_WORLD);
+
+	if(input != NULL) {
+		batch(input, output);
+		migration.free();
+		hall.free();
+		MPI_Finalize();
+		return( EXIT_SUCCESS );
+	}
+
+	if(grid != NULL) {
+		std::string points;
+		if(load(grid, points) == false) {
+			MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+		}
+		sweep(settings, share(points));
+		migration.free();
+		hall.free();
+		MPI_Finalize();
+		return( EXIT_SUCCESS );
+	}
+
+	if(parallel == true) {
+		concurrent();
+		migration.free();
+		hall.free();
+		MPI_Finalize();
+		return( EXIT_SUCCESS );
+	}
+
+	if(resume == true && checkpoint.read(phase, start, records) == true) {
+		/* Each rank continues with its own cube and random numbers. */
+		GeneticAlgorithm ga;
+		Checkpoint::restore(records[rank], seed, shuffled, path, ga);
+
+		if(start >= Configuration::instance().broadcasts) {
+			phase++;
+			start = 0;
+		}
+
+		if(rank == ROOT_NODE) {
+			std::cout << "Resume : " << (phase+1) << " " << start << std::endl;
+		}
+	} else {
+		/* Firs process will distribute the working tasks. */
+		shuffle();
+	}
+
+	if(rank == ROOT_NODE && provided >= MPI_THREAD_FUNNELED && ProgressLog::instance().start(PROGRESS_LOG_FILE, resume) == false && std::string(PROGRESS_LOG_FILE) != "") {
+		std::cerr << "Progress log can not be written : " << PROGRESS_LOG_FILE << std::endl;
+	}
+
+	for(; phase<EXPERIMENTS; phase++) {
+		experiment(phase);
+		checkpoint.flush();
+		start = 0;
+	}
+
+	ProgressLog::instance().stop();
 
+	migration.free();
+	hall.free();
 	MPI_Finalize();
 
 	return( EXIT_SUCCESS );
@@ -0,0 +1,241 @@
+#ifndef RUBIKSCUBEMOVES_H_INCLUDED
+#define RUBIKSCUBEMOVES_H_INCLUDED
+
+#include "RubiksCube.h"
+
+/*
+ * Each move as a list of the facelets which it changes. The tables are taken
+ * from the spins of RubiksCube, so both ways of moving give the same cube.
+ */
+template<int N>
+class RubiksCubeMoves {
+public:
+	static const int FACELETS = 6*N*N;
+
+	/* Turns of the sides and of the inner layers. */
+	static const int COUNT = 6*(N/2);
+
+	/* Macro genes, which are compositions of turns. */
+	static const int MACROS = MACRO_COUNT;
+
+	/* Bytes are enough for the facelets of the small cubes. */
+	typedef typename std::conditional<(FACELETS<=256), unsigned char, unsigned short>::type Index;
+
+	struct Move {
+		int count;
+
+		/* The first facelets in the lists are in cycles which cross sides. */
+		int crossings;
+
+		/* Facelet targets[k] takes the color of facelet sources[k]. */
+		Index targets[FACELETS];
+		Index sources[FACELETS];
+	};
+
+private:
+	/* Turns and after them the macro genes. */
+	Move moves[COUNT+MACROS];
+
+	/* Move for each command character, -1 for no-operation and unknown characters. */
+	int indices[256];
+
+	/* Moves which do not share facelets give the same cube in any order. */
+	bool independent[COUNT][COUNT];
+
+	/* Largest number of facelets changed by a move on a single side, with and without the facelets from the same side. */
+	int counts[2];
+
+	static RubiksCubeState<N> turn(const RubiksCubeState<N> &state, RubiksSide side, int depth) {
+		RubiksCube<N> cube;
+		cube.setState(state);
+		cube.callSpin(side, CLOCKWISE, 1, depth);
+		return( cube.getState() );
+	}
+
+	/*
+	 * Facelet f takes the color of facelet sources[f]. Facelets of the cycles
+	 * which stay on a single side are put last, because they only move colors
+	 * inside the side.
+	 */
+	static void fill(Move &move, const int sources[]) {
+		bool inside[FACELETS];
+		for(int f=0; f<FACELETS; f++) {
+			inside[f] = true;
+			for(int g=sources[f]; g!=f; g=sources[g]) {
+				if(g/(N*N) != f/(N*N)) {
+					inside[f] = false;
+				}
+			}
+		}
+
+		move.count = 0;
+		move.crossings = 0;
+		for(int pass=0; pass<2; pass++) {
+			for(int f=0; f<FACELETS; f++) {
+				if(sources[f] == f || inside[f] != (pass == 1)) {
+					continue;
+				}
+
+				move.targets[move.count] = f;
+				move.sources[move.count] = sources[f];
+				move.count++;
+			}
+
+			if(pass == 0) {
+				move.crossings = move.count;
+			}
+		}
+	}
+
+	static RubiksCubeMoves<N>& table() {
+		static RubiksCubeMoves<N> moves;
+		return( moves );
+	}
+
+	RubiksCubeMoves() {
+		const std::string &commands = RubiksCube<N>::alphabet();
+
+		for(int c=0; c<256; c++) {
+			indices[c] = -1;
+		}
+
+		counts[0] = counts[1] = 0;
+		for(int m=0; m<COUNT; m++) {
+			indices[(unsigned char)commands[m]] = m;
+
+			RubiksSide side = NONE;
+			int depth = 0;
+			RubiksCube<N>::decode(commands[m], side, depth);
+
+			/* Each facelet is marked with its own index, in two bytes for the big cubes, and the move shows where it goes. */
+			RubiksCubeState<N> low;
+			RubiksCubeState<N> high;
+			for(int f=0; f<FACELETS; f++) {
+				(&low.sides[0][0][0])[f] = f & 0xFF;
+				(&high.sides[0][0][0])[f] = f >> 8;
+			}
+			low = turn(low, side, depth);
+			high = turn(high, side, depth);
+
+			int result[FACELETS];
+			for(int f=0; f<FACELETS; f++) {
+				result[f] = (&low.sides[0][0][0])[f] | (&high.sides[0][0][0])[f] << 8;
+			}
+
+			fill(moves[m], result);
+
+			int sides[2][6] = {{0}};
+			for(int k=0; k<moves[m].count; k++) {
+				sides[0][moves[m].targets[k]/(N*N)]++;
+				if(k < moves[m].crossings) {
+					sides[1][moves[m].targets[k]/(N*N)]++;
+				}
+			}
+
+			for(int s=0; s<6; s++) {
+				for(int k=0; k<2; k++) {
+					if(counts[k] < sides[k][s]) {
+						counts[k] = sides[k][s];
+					}
+				}
+			}
+		}
+
+		for(int m1=0; m1<COUNT; m1++) {
+			for(int m2=0; m2<COUNT; m2++) {
+				bool marks[FACELETS] = {false};
+				for(int k=0; k<moves[m1].count; k++) {
+					marks[moves[m1].targets[k]] = true;
+				}
+
+				independent[m1][m2] = (m1 != m2);
+				for(int k=0; k<moves[m2].count; k++) {
+					if(marks[moves[m2].targets[k]] == true) {
+						independent[m1][m2] = false;
+					}
+				}
+			}
+		}
+	}
+
+public:
+	static const RubiksCubeMoves<N>& instance() {
+		return( table() );
+	}
+
+	/* Macro genes as single moves, each composed from its sequence of turns. Previous macro genes are removed. */
+	static void define(const std::string &symbols, const std::vector<std::string> &sequences) {
+		RubiksCubeMoves<N> &moves = table();
+
+		for(int c=0; c<256; c++) {
+			if(moves.indices[c] >= COUNT) {
+				moves.indices[c] = -1;
+			}
+		}
+
+		for(int i=0; i<symbols.length() && i<sequences.size() && i<MACROS; i++) {
+			Index labels[FACELETS];
+			for(int f=0; f<FACELETS; f++) {
+				labels[f] = f;
+			}
+			for(int k=0; k<sequences[i].length(); k++) {
+				const Move *move = moves.find(sequences[i][k]);
+				if(move != NULL) {
+					apply(*move, labels);
+				}
+			}
+
+			int sources[FACELETS];
+			for(int f=0; f<FACELETS; f++) {
+				sources[f] = labels[f];
+			}
+			fill(moves.moves[COUNT+i], sources);
+			moves.indices[(unsigned char)symbols[i]] = COUNT + i;
+		}
+	}
+
+	/* Null for commands which do not change the cube. */
+	const Move* find(char command) const {
+		int index = indices[(unsigned char)command];
+		return( index<0 ? NULL : &moves[index] );
+	}
+
+	bool commute(char first, char second) const {
+		int m1 = indices[(unsigned char)first];
+		int m2 = indices[(unsigned char)second];
+		return( m1>=0 && m1<COUNT && m2>=0 && m2<COUNT && independent[m1][m2] );
+	}
+
+	/* Largest number of facelets changed by any move. */
+	int maximum(bool crossings) const {
+		int result = 0;
+		for(int m=0; m<COUNT; m++) {
+			int count = crossings ? moves[m].crossings : moves[m].count;
+			if(result < count) {
+				result = count;
+			}
+		}
+
+		return( result );
+	}
+
+	/* Largest number of facelets changed by any move on a single side. */
+	int maximumOnSide(bool crossings) const {
+		return( counts[crossings ? 1 : 0] );
+	}
+
+	/* Facelets are colors or labels of the places. */
+	template<typename T>
+	static void apply(const Move &move, T facelets[]) {
+		T buffer[FACELETS];
+
+		for(int k=0; k<move.count; k++) {
+			buffer[k] = facelets[move.sources[k]];
+		}
+		for(int k=0; k<move.count; k++) {
+			facelets[move.targets[k]] = buffer[k];
+		}
+	}
+};
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef RUBIKSCUBESTATE_H_INCLUDED
+#define RUBIKSCUBESTATE_H_INCLUDED
+
+/*
+ * Colors of all sides as a plain value without pointers and heap members, so
+ * it can be copied with memcpy, kept in arrays and sent as raw bytes.
+ */
+template<int N>
+struct RubiksCubeState {
+	/* Order of the sides. */
+	enum {
+		TOP_SIDE = 0,
+		LEFT_SIDE = 1,
+		RIGHT_SIDE = 2,
+		FRONT_SIDE = 3,
+		BACK_SIDE = 4,
+		DOWN_SIDE = 5,
+	};
+
+	unsigned char sides[6][N][N];
+
+	/* Hash of the raw facelets. */
+	unsigned long long hash() const {
+		unsigned long long words[(sizeof(sides)+7)/8] = {0};
+		memcpy(words, sides, sizeof(sides));
+
+		unsigned long long value = 0;
+		for(int w=0; w<sizeof(words)/sizeof(words[0]); w++) {
+			value = (value ^ words[w]) * 0x9E3779B97F4A7C15ULL;
+		}
+
+		return( value ^ (value >> 32) );
+	}
+};
+
+#endif
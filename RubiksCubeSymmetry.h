@@ -0,0 +1,258 @@
+#ifndef RUBIKSCUBESYMMETRY_H_INCLUDED
+#define RUBIKSCUBESYMMETRY_H_INCLUDED
+
+#include "RubiksCube.h"
+#include "RubiksCubeMoves.h"
+
+/*
+ * Whole-cube rotations and reflections as permutations of the facelets
+ * together with a relabeling of the colors, so the solved cube stays solved.
+ *
+ * A symmetry is a permutation of the sides which keeps opposite sides
+ * opposite. Each facelet is known by its side and by the set of moves which
+ * move it (a layer at some depth from some side), so the facelet permutation
+ * follows from the side permutation.
+ * Every symmetry is checked against the moves: rotations turn clockwise moves
+ * into clockwise moves and reflections into counter-clockwise moves.
+ *
+ * Only commands are clockwise turns, so the number of moves to a cube is kept
+ * by rotations, but not by reflections.
+ */
+template<int N>
+class RubiksCubeSymmetry {
+public:
+	static const int COUNT = 48;
+
+	static const int FACELETS = RubiksCubeMoves<N>::FACELETS;
+
+	typedef typename RubiksCubeMoves<N>::Index Index;
+
+private:
+	/* Facelet p of the transformed cube takes the color of facelet sources[s][p]. */
+	Index sources[COUNT][FACELETS];
+
+	/* New color for each old color. */
+	unsigned char colors[COUNT][256];
+
+	/* Command which takes the place of each command. */
+	char commands[COUNT][256];
+
+	bool reflections[COUNT];
+
+	int inverses[COUNT];
+
+	RubiksCubeSymmetry() {
+		const RubiksCubeMoves<N> &moves = RubiksCubeMoves<N>::instance();
+		const std::string &alphabet = RubiksCube<N>::alphabet();
+
+		/* Side and depth of each move and the moves which change each facelet. */
+		int sides[RubiksCubeMoves<N>::COUNT];
+		int depths[RubiksCubeMoves<N>::COUNT];
+		char turns[6];
+		long long masks[FACELETS] = {0};
+		for(int m=0; m<RubiksCubeMoves<N>::COUNT; m++) {
+			RubiksSide side = NONE;
+			RubiksCube<N>::decode(alphabet[m], side, depths[m]);
+
+			/* The turned side is the side of the last facelets of a turn, which do not cross sides. */
+			const typename RubiksCubeMoves<N>::Move *move = moves.find(RubiksCube<N>::command(side, 0));
+			sides[m] = move->targets[move->count-1] / (N*N);
+			if(depths[m] == 0) {
+				turns[sides[m]] = alphabet[m];
+			}
+
+			move = moves.find(alphabet[m]);
+			for(int k=0; k<move->count; k++) {
+				masks[move->targets[k]] |= 1LL << m;
+			}
+		}
+
+		int opposites[6];
+		for(int s1=0; s1<6; s1++) {
+			for(int s2=0; s2<6; s2++) {
+				if(moves.commute(turns[s1], turns[s2]) == true) {
+					opposites[s1] = s2;
+				}
+			}
+		}
+
+		/* Colors of the sides of the solved cube. */
+		const RubiksCubeState<N> solved = RubiksCube<N>().getState();
+
+		/* Permutations of the sides in lexicographic order, so the identity is the first one. */
+		int permutation[6] = {0, 1, 2, 3, 4, 5};
+		int count = 0;
+		do {
+			bool valid = true;
+			for(int s=0; s<6; s++) {
+				if(permutation[opposites[s]] != opposites[permutation[s]]) {
+					valid = false;
+				}
+			}
+			if(valid == false) {
+				continue;
+			}
+
+			/* Move of the permuted side at the same depth. */
+			int images[RubiksCubeMoves<N>::COUNT];
+			for(int m1=0; m1<RubiksCubeMoves<N>::COUNT; m1++) {
+				for(int m2=0; m2<RubiksCubeMoves<N>::COUNT; m2++) {
+					if(sides[m2] == permutation[sides[m1]] && depths[m2] == depths[m1]) {
+						images[m1] = m2;
+					}
+				}
+			}
+
+			/* Facelet f goes to the facelet with the permuted side and the permuted set of moves. */
+			int targets[FACELETS];
+			for(int f=0; f<FACELETS; f++) {
+				long long mask = 0;
+				for(int m=0; m<RubiksCubeMoves<N>::COUNT; m++) {
+					if((masks[f] & (1LL << m)) != 0) {
+						mask |= 1LL << images[m];
+					}
+				}
+				for(int g=0; g<FACELETS; g++) {
+					if(g/(N*N) == permutation[f/(N*N)] && masks[g] == mask) {
+						targets[f] = g;
+					}
+				}
+			}
+			for(int f=0; f<FACELETS; f++) {
+				sources[count][targets[f]] = f;
+			}
+
+			for(int c=0; c<256; c++) {
+				colors[count][c] = c;
+				commands[count][c] = c;
+			}
+			for(int s=0; s<6; s++) {
+				colors[count][solved.sides[s][0][0]] = solved.sides[permutation[s]][0][0];
+			}
+			for(int m=0; m<RubiksCubeMoves<N>::COUNT; m++) {
+				commands[count][(unsigned char)alphabet[m]] = alphabet[images[m]];
+			}
+
+			reflections[count] = (check(count, false) == false);
+			if(reflections[count] == true && check(count, true) == false) {
+				continue;
+			}
+
+			count++;
+		} while(std::next_permutation(permutation, permutation+6));
+
+		for(int s1=0; s1<COUNT; s1++) {
+			for(int s2=0; s2<COUNT; s2++) {
+				if(compose(s1, s2) == true) {
+					inverses[s1] = s2;
+				}
+			}
+		}
+	}
+
+	/* Each move and then the symmetry should be the same as the symmetry and then the permuted move in the given direction. */
+	bool check(int symmetry, bool reverse) const {
+		const std::string &alphabet = RubiksCube<N>::alphabet();
+
+		for(int m=0; m<alphabet.length(); m++) {
+			Index turned[FACELETS];
+			Index transformed[FACELETS];
+			for(int f=0; f<FACELETS; f++) {
+				turned[f] = f;
+				transformed[f] = sources[symmetry][f];
+			}
+
+			RubiksCubeMoves<N>::apply(*RubiksCubeMoves<N>::instance().find(alphabet[m]), turned);
+			const typename RubiksCubeMoves<N>::Move *move = RubiksCubeMoves<N>::instance().find(commands[symmetry][(unsigned char)alphabet[m]]);
+			for(int t=0; t<(reverse ? 3 : 1); t++) {
+				RubiksCubeMoves<N>::apply(*move, transformed);
+			}
+
+			for(int p=0; p<FACELETS; p++) {
+				if(turned[sources[symmetry][p]] != transformed[p]) {
+					return( false );
+				}
+			}
+		}
+
+		return( true );
+	}
+
+	/* True when the second symmetry undoes the first one. */
+	bool compose(int first, int second) const {
+		for(int p=0; p<FACELETS; p++) {
+			if(sources[first][sources[second][p]] != p) {
+				return( false );
+			}
+		}
+
+		return( true );
+	}
+
+public:
+	static const RubiksCubeSymmetry<N>& instance() {
+		static const RubiksCubeSymmetry<N> symmetry;
+		return( symmetry );
+	}
+
+	bool isReflection(int symmetry) const {
+		return( reflections[symmetry] );
+	}
+
+	int inverse(int symmetry) const {
+		return( inverses[symmetry] );
+	}
+
+	/* Command on the transformed cube which does the same as the command on the original cube. For reflections it is the turn in the other direction. */
+	char command(int symmetry, char command) const {
+		return( commands[symmetry][(unsigned char)command] );
+	}
+
+	void transform(int symmetry, const RubiksCubeState<N> &state, RubiksCubeState<N> &result) const {
+		const unsigned char *values = &state.sides[0][0][0];
+		unsigned char *out = &result.sides[0][0][0];
+
+		for(int p=0; p<FACELETS; p++) {
+			out[p] = colors[symmetry][values[sources[symmetry][p]]];
+		}
+	}
+
+	/*
+	 * Smallest transformed cube in byte order and the symmetry which gives it.
+	 * Candidates are compared facelet by facelet and most of them are dropped
+	 * after a few facelets.
+	 */
+	int canonical(const RubiksCubeState<N> &state, RubiksCubeState<N> &result, bool mirrors=false) const {
+		const unsigned char *values = &state.sides[0][0][0];
+		unsigned char *out = &result.sides[0][0][0];
+
+		int best = 0;
+		transform(best, state, result);
+		for(int s=1; s<COUNT; s++) {
+			if(mirrors == false && reflections[s] == true) {
+				continue;
+			}
+
+			int p = 0;
+			unsigned char value = 0;
+			for(; p<FACELETS; p++) {
+				value = colors[s][values[sources[s][p]]];
+				if(value != out[p]) {
+					break;
+				}
+			}
+			if(p == FACELETS || value > out[p]) {
+				continue;
+			}
+
+			for(; p<FACELETS; p++) {
+				out[p] = colors[s][values[sources[s][p]]];
+			}
+			best = s;
+		}
+
+		return( best );
+	}
+};
+
+#endif
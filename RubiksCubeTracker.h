@@ -0,0 +1,203 @@
+#ifndef RUBIKSCUBETRACKER_H_INCLUDED
+#define RUBIKSCUBETRACKER_H_INCLUDED
+
+#include "RubiksCube.h"
+#include "RubiksCubeMoves.h"
+
+/*
+ * Cube which keeps its distance to a reference cube up to date after each
+ * move. Only the facelets changed by the move are visited, so the distance
+ * after every prefix of the commands is known without extra work.
+ */
+template<int N>
+class RubiksCubeTracker {
+private:
+	DistanceType type;
+
+	RubiksCubeState<N> reference;
+
+	RubiksCubeState<N> current;
+
+	/* When each side of the reference has a single color, turning facelets inside a side does not change the distance. */
+	bool uniform;
+
+	/* Sum of the squared differences of all facelets for the Euclidean distance. */
+	int squares;
+
+	/* Sum of the coefficients of all facelets for the weighted distance. */
+	double weights;
+
+	/* Sums of the squared differences between reference side s1 and current side s2 for the Hausdorff distance. */
+	int sides[6][6];
+
+public:
+	RubiksCubeTracker(const RubiksCube<N> &reference, const RubiksCube<N> &cube) {
+		this->type = reference.getDistanceType();
+		this->reference = reference.getState();
+		this->current = cube.getState();
+
+		uniform = true;
+		for(int s=0; s<6; s++) {
+			for(int i=0; i<N; i++) {
+				for(int j=0; j<N; j++) {
+					if(this->reference.sides[s][i][j] != this->reference.sides[s][N/2][N/2]) {
+						uniform = false;
+					}
+				}
+			}
+		}
+
+		squares = 0;
+		weights = 0;
+		for(int s1=0; s1<6; s1++) {
+			for(int s2=0; s2<6; s2++) {
+				sides[s1][s2] = 0;
+			}
+		}
+
+		for(int s=0; s<6; s++) {
+			for(int i=0; i<N; i++) {
+				for(int j=0; j<N; j++) {
+					int value = current.sides[s][i][j];
+					squares += (this->reference.sides[s][i][j]-value)*(this->reference.sides[s][i][j]-value);
+					weights += RubiksCube<N>::coefficient(this->reference.sides[s][N/2][N/2], value);
+					for(int r=0; r<6; r++) {
+						sides[r][s] += (this->reference.sides[r][i][j]-value)*(this->reference.sides[r][i][j]-value);
+					}
+				}
+			}
+		}
+	}
+
+	/* Value which grows together with the distance, but without the square root. */
+	double measure() const {
+		switch(type) {
+		case EUCLIDEAN:
+			return( squares );
+		case WEIGHTED:
+			return( weights );
+		case HAUSDORFF: {
+			int result = 0;
+			for(int s1=0; s1<6; s1++) {
+				int minimum = sides[s1][0];
+				for(int s2=1; s2<6; s2++) {
+					if(minimum > sides[s1][s2]) {
+						minimum = sides[s1][s2];
+					}
+				}
+				if(result < minimum) {
+					result = minimum;
+				}
+			}
+			return( result );
+		}
+		}
+
+		return( INVALID_FITNESS_VALUE );
+	}
+
+	double distance(double measure) const {
+		if(type == WEIGHTED) {
+			return( measure );
+		}
+
+		return( sqrt(measure) );
+	}
+
+	/* Largest change of the measure which a single move can give. Colors are from 1 to 6. */
+	double bound() const {
+		const RubiksCubeMoves<N> &moves = RubiksCubeMoves<N>::instance();
+		const int difference = (PURPLE-RED) * (PURPLE-RED);
+
+		switch(type) {
+		case EUCLIDEAN:
+			return( moves.maximum(uniform) * difference );
+		case WEIGHTED:
+			return( moves.maximum(uniform) * (4 - 1) );
+		case HAUSDORFF:
+			/* Only the sums of the sides with changed facelets are changed. */
+			return( moves.maximumOnSide(uniform) * difference );
+		}
+
+		return( INVALID_FITNESS_VALUE );
+	}
+
+	const RubiksCubeState<N>& getState() const {
+		return( current );
+	}
+
+	const RubiksCubeState<N>& getReference() const {
+		return( reference );
+	}
+
+	DistanceType getDistanceType() const {
+		return( type );
+	}
+
+	double distance() const {
+		return( distance(measure()) );
+	}
+
+	void move(char command) {
+		const typename RubiksCubeMoves<N>::Move *move = RubiksCubeMoves<N>::instance().find(command);
+		if(move == NULL) {
+			return;
+		}
+
+		/* Byte pointers may alias anything, so the sums are kept in local variables. */
+		const int count = uniform ? move->crossings : move->count;
+		const unsigned char *origin = &reference.sides[0][0][0];
+		unsigned char *values = &current.sides[0][0][0];
+		unsigned char previous[RubiksCubeMoves<N>::FACELETS];
+		memcpy(previous, values, sizeof(previous));
+		for(int k=0; k<move->count; k++) {
+			values[move->targets[k]] = previous[move->sources[k]];
+		}
+
+		/* Distance is changed only by the facelets which are changed. */
+		switch(type) {
+		case EUCLIDEAN: {
+			int sum = squares;
+			for(int k=0; k<count; k++) {
+				int facelet = move->targets[k];
+				int after = origin[facelet] - previous[move->sources[k]];
+				int before = origin[facelet] - previous[facelet];
+				sum += after*after - before*before;
+			}
+			squares = sum;
+		}
+		break;
+		case WEIGHTED: {
+			double sum = weights;
+			for(int k=0; k<count; k++) {
+				int facelet = move->targets[k];
+				int center = origin[(facelet/(N*N))*N*N + (N/2)*N + N/2];
+				sum += RubiksCube<N>::coefficient(center, previous[move->sources[k]]) - RubiksCube<N>::coefficient(center, previous[facelet]);
+			}
+			weights = sum;
+		}
+		break;
+		case HAUSDORFF: {
+			int sums[6][6];
+			memcpy(sums, sides, sizeof(sums));
+			for(int k=0; k<count; k++) {
+				int facelet = move->targets[k];
+				int side = facelet / (N*N);
+				int place = facelet % (N*N);
+				int after = previous[move->sources[k]];
+				int before = previous[facelet];
+				for(int s=0; s<6; s++) {
+					int value = origin[s*N*N + place];
+					sums[s][side] += (value-after)*(value-after) - (value-before)*(value-before);
+				}
+			}
+			memcpy(sides, sums, sizeof(sums));
+		}
+		break;
+		}
+	}
+};
+
+static_assert(std::is_trivially_copyable< RubiksCubeTracker<CUBE_SIZE> >::value, "Tracker should be copied as raw bytes.");
+
+#endif
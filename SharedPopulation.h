@@ -0,0 +1,220 @@
+#ifndef SHAREDPOPULATION_H_INCLUDED
+#define SHAREDPOPULATION_H_INCLUDED
+
+#include "Chromosome.h"
+#include "GeneticAlgorithm.h"
+
+/*
+ * Population which is evolved by many threads at the same time, in steady
+ * state and without locks. Each slot has a version, which is odd while the
+ * slot is written. A chromosome is read when the version is the same before
+ * and after the copy, and it is replaced only when the version is still the
+ * one seen at the selection, so a slot changed by another thread in the
+ * meantime is not overwritten and the offspring is dropped.
+ *
+ * Fitness values, hashes and the indices of the best and the worst slots are
+ * atomic, so the selection reads them without the versions. The indices can
+ * be one replacement behind and each replacement corrects them.
+ */
+class SharedPopulation {
+private:
+	struct Slot {
+		std::atomic<unsigned long> version;
+		std::atomic<double> fitness;
+		std::atomic<size_t> genome;
+		std::atomic<unsigned long long> state;
+		std::atomic<int> length;
+		char command[PANMICTIC_LENGTH];
+	};
+
+	std::vector<Slot> slots;
+
+	std::atomic<int> best;
+
+	std::atomic<int> worst;
+
+	/* Both indices from all fitness values, when the moved index can not be corrected alone. */
+	void rescan() {
+		int minimum = 0;
+		int maximum = 0;
+		for(int i=0; i<slots.size(); i++) {
+			double fitness = slots[i].fitness.load(std::memory_order_relaxed);
+			if(fitness < slots[minimum].fitness.load(std::memory_order_relaxed)) {
+				minimum = i;
+			}
+			if(fitness > slots[maximum].fitness.load(std::memory_order_relaxed)) {
+				maximum = i;
+			}
+		}
+
+		best.store(minimum);
+		worst.store(maximum);
+	}
+
+	void update(int index, double fitness) {
+		if(index == best.load() || index == worst.load()) {
+			rescan();
+			return;
+		}
+
+		int current = best.load();
+		while(fitness < slots[current].fitness.load(std::memory_order_relaxed) && best.compare_exchange_weak(current, index) == false) {
+		}
+
+		current = worst.load();
+		while(fitness > slots[current].fitness.load(std::memory_order_relaxed) && worst.compare_exchange_weak(current, index) == false) {
+		}
+	}
+
+public:
+	/* False when a chromosome of the population does not fit in a slot. */
+	static bool holds(GeneticAlgorithm &ga) {
+		for(int i=0; i<ga.size(); i++) {
+			if(ga.getChromosome(i).command.length() > PANMICTIC_LENGTH) {
+				return( false );
+			}
+		}
+
+		return( true );
+	}
+
+	/* Population should be checked with holds() before. */
+	SharedPopulation(GeneticAlgorithm &ga) : slots(ga.size()) {
+		for(int i=0; i<slots.size(); i++) {
+			const Chromosome &chromosome = ga.getChromosome(i);
+			int length = chromosome.command.length();
+
+			slots[i].version.store(0);
+			slots[i].fitness.store(chromosome.fitness);
+			slots[i].genome.store(chromosome.genome);
+			slots[i].state.store(chromosome.state);
+			slots[i].length.store(length);
+			memcpy(slots[i].command, chromosome.command.data(), length);
+		}
+
+		rescan();
+	}
+
+	/* Should be called when no thread uses the population. */
+	void store(GeneticAlgorithm &ga) const {
+		GeneticAlgorithm result;
+		for(int i=0; i<slots.size(); i++) {
+			result.setChromosome( Chromosome(std::string(slots[i].command, slots[i].length.load()),slots[i].fitness.load(),slots[i].state.load()) );
+		}
+		ga = result;
+	}
+
+	int size() const {
+		return( slots.size() );
+	}
+
+	int getBestIndex() const {
+		return( best.load() );
+	}
+
+	double getFitness(int index) const {
+		return( slots[index].fitness.load(std::memory_order_relaxed) );
+	}
+
+	double getBestFitness() const {
+		return( getFitness(best.load()) );
+	}
+
+	/* Version of the slot when it is not written at the moment, odd otherwise. */
+	unsigned long getVersion(int index) const {
+		return( slots[index].version.load(std::memory_order_acquire) );
+	}
+
+	/* False when the slot is written during all attempts. */
+	bool read(int index, Chromosome &chromosome) const {
+		static const int ATTEMPTS = 100;
+
+		const Slot &slot = slots[index];
+		for(int a=0; a<ATTEMPTS; a++) {
+			unsigned long version = slot.version.load(std::memory_order_acquire);
+			if(version%2 == 1) {
+				continue;
+			}
+
+			int length = slot.length.load(std::memory_order_relaxed);
+			std::string command(slot.command, length);
+			double fitness = slot.fitness.load(std::memory_order_relaxed);
+			unsigned long long state = slot.state.load(std::memory_order_relaxed);
+
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if(slot.version.load(std::memory_order_relaxed) == version) {
+				chromosome = Chromosome(command, fitness, state);
+				return( true );
+			}
+		}
+
+		return( false );
+	}
+
+	Chromosome getChromosome(int index) const {
+		Chromosome chromosome;
+		read(index, chromosome);
+		return( chromosome );
+	}
+
+	Chromosome getBestChromosome() const {
+		Chromosome chromosome;
+		read(best.load(), chromosome);
+		return( chromosome );
+	}
+
+	Chromosome getWorstChromosome() const {
+		Chromosome chromosome;
+		read(worst.load(), chromosome);
+		return( chromosome );
+	}
+
+	/* True when a chromosome with the same hash of the commands or the same known cube is in the population. */
+	bool contains(const Chromosome &chromosome) const {
+		for(int i=0; i<slots.size(); i++) {
+			if(slots[i].genome.load(std::memory_order_relaxed) == chromosome.genome) {
+				return( true );
+			}
+			if(chromosome.state != 0 && slots[i].state.load(std::memory_order_relaxed) == chromosome.state) {
+				return( true );
+			}
+		}
+
+		return( false );
+	}
+
+	/* False when the slot was changed after the given version was seen or the chromosome does not fit in it. */
+	bool replace(int index, unsigned long version, const Chromosome &chromosome) {
+		if(version%2 == 1 || chromosome.command.length() > PANMICTIC_LENGTH) {
+			return( false );
+		}
+
+		Slot &slot = slots[index];
+		if(slot.version.compare_exchange_strong(version, version+1, std::memory_order_acquire) == false) {
+			return( false );
+		}
+		std::atomic_thread_fence(std::memory_order_release);
+
+		slot.fitness.store(chromosome.fitness, std::memory_order_relaxed);
+		slot.genome.store(chromosome.genome, std::memory_order_relaxed);
+		slot.state.store(chromosome.state, std::memory_order_relaxed);
+		slot.length.store(chromosome.command.length(), std::memory_order_relaxed);
+		memcpy(slot.command, chromosome.command.data(), chromosome.command.length());
+		slot.version.store(version+2, std::memory_order_release);
+
+		update(index, chromosome.fitness);
+		return( true );
+	}
+
+	/* Clones are not inserted. */
+	void replaceWorst(const Chromosome &chromosome) {
+		if(contains(chromosome) == true) {
+			return;
+		}
+
+		int index = worst.load();
+		replace(index, getVersion(index), chromosome);
+	}
+};
+
+#endif
@@ -0,0 +1,199 @@
+#ifndef TASKPOOL_H_INCLUDED
+#define TASKPOOL_H_INCLUDED
+
+#include "GeneticAlgorithm.h"
+
+/*
+ * Threads which run small tasks of very different length, as evaluations of
+ * chromosomes with a few or with thousands of genes. Each thread has its own
+ * deque: it takes its newest task from the back and, when it has none, it
+ * steals the oldest task of another thread from the front. The thread which
+ * waits for the tasks runs them too.
+ *
+ * Each thread counts its tasks, its stolen tasks and its busy time, so the
+ * utilization of the cores can be reported.
+ */
+class TaskPool {
+private:
+	struct Worker {
+		std::mutex mutex;
+		std::deque< std::function<void()> > tasks;
+		std::atomic<long> executed;
+		std::atomic<long> stolen;
+		std::atomic<long long> busy;
+	};
+
+	/* Index 0 is the thread which submits the tasks and waits for them. */
+	std::vector<Worker> workers;
+
+	std::vector<std::thread> threads;
+
+	/* Submitted tasks which are not finished. */
+	std::atomic<long> pending;
+
+	/* Submitted tasks which are not taken by any thread yet. */
+	std::atomic<long> queued;
+
+	std::atomic<bool> running;
+
+	std::mutex sleeping;
+
+	std::condition_variable wakeup;
+
+	std::chrono::steady_clock::time_point since;
+
+	/* Index of the calling thread in the pool. */
+	static int& current() {
+		static thread_local int index = 0;
+		return( index );
+	}
+
+	bool take(int index, std::function<void()> &task) {
+		for(int i=0; i<workers.size(); i++) {
+			Worker &worker = workers[(index+i)%workers.size()];
+			std::lock_guard<std::mutex> lock(worker.mutex);
+			if(worker.tasks.empty() == true) {
+				continue;
+			}
+
+			if(i == 0) {
+				task = std::move(worker.tasks.back());
+				worker.tasks.pop_back();
+			} else {
+				task = std::move(worker.tasks.front());
+				worker.tasks.pop_front();
+				workers[index].stolen++;
+			}
+			queued--;
+			return( true );
+		}
+
+		return( false );
+	}
+
+	void run(int index, std::function<void()> &task) {
+		std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+		task();
+		workers[index].busy += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now()-begin).count();
+		workers[index].executed++;
+		pending--;
+	}
+
+	void loop(int index, unsigned seed) {
+		current() = index;
+		std::minstd_rand engine(seed);
+		GeneticAlgorithm::setEngine(&engine);
+
+		std::function<void()> task;
+		while(running.load() == true) {
+			if(take(index, task) == true) {
+				run(index, task);
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock(sleeping);
+			wakeup.wait_for(lock, std::chrono::milliseconds(1), [this]() {
+				return( queued.load() > 0 || running.load() == false );
+			});
+		}
+
+		GeneticAlgorithm::setEngine(NULL);
+	}
+
+	TaskPool(int size) : workers(size>1 ? size : 1) {
+		pending.store(0);
+		queued.store(0);
+		running.store(true);
+		reset();
+
+		for(int t=1; t<workers.size(); t++) {
+			unsigned seed = rand();
+			threads.push_back(std::thread([this, t, seed]() {
+				loop(t, seed);
+			}));
+		}
+	}
+
+public:
+	static TaskPool& instance() {
+		static TaskPool pool(EVALUATION_THREADS);
+		return( pool );
+	}
+
+	~TaskPool() {
+		running.store(false);
+		wakeup.notify_all();
+		for(int t=0; t<threads.size(); t++) {
+			threads[t].join();
+		}
+	}
+
+	int size() const {
+		return( workers.size() );
+	}
+
+	/* The task is put in the deque of the calling thread. */
+	void submit(std::function<void()> task) {
+		Worker &worker = workers[current()];
+		{
+			std::lock_guard<std::mutex> lock(worker.mutex);
+			worker.tasks.push_back(std::move(task));
+		}
+		pending++;
+		queued++;
+		wakeup.notify_all();
+	}
+
+	/* Tasks are run by the waiting thread too, until all of them are finished. */
+	void wait() {
+		const int index = current();
+
+		std::function<void()> task;
+		while(pending.load() > 0) {
+			if(take(index, task) == true) {
+				run(index, task);
+			} else {
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	/* Counters start again from zero. */
+	void reset() {
+		for(int t=0; t<workers.size(); t++) {
+			workers[t].executed.store(0);
+			workers[t].stolen.store(0);
+			workers[t].busy.store(0);
+		}
+		since = std::chrono::steady_clock::now();
+	}
+
+	long getExecuted(int thread) const {
+		return( workers[thread].executed.load() );
+	}
+
+	long getStolen(int thread) const {
+		return( workers[thread].stolen.load() );
+	}
+
+	double getBusy(int thread) const {
+		return( workers[thread].busy.load() / 1e9 );
+	}
+
+	/* Part of the time since the reset in which the threads ran tasks. */
+	double getUtilization() const {
+		double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now()-since).count();
+		if(elapsed <= 0) {
+			return( 0 );
+		}
+
+		double busy = 0;
+		for(int t=0; t<workers.size(); t++) {
+			busy += getBusy(t);
+		}
+
+		return( busy / (elapsed*workers.size()) );
+	}
+};
+
+#endif